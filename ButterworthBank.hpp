@@ -0,0 +1,411 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+#pragma once
+#include "ButterworthSynth.hpp"
+#include <cstddef>
+#include <cstring>
+#include <utility>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace butterworth_simd {
+
+// Minimal vector of T used by ButterworthIIRBank. Loads and stores are unaligned because
+// the bank may live in heap memory that is only aligned to 8 or 16 bytes.
+template <typename T>
+struct Vec { // portable fallback, one lane at a time
+    static constexpr std::size_t width = 1;
+    T v;
+    static Vec load(const T* p) { return {*p}; }
+    static Vec set1(T s) { return {s}; }
+    void store(T* p) const { *p = v; }
+    Vec operator+(const Vec& o) const { return {v + o.v}; }
+    Vec operator-(const Vec& o) const { return {v - o.v}; }
+    Vec operator*(const Vec& o) const { return {v * o.v}; }
+};
+
+#if defined(__AVX__)
+template <>
+struct Vec<double> {
+    static constexpr std::size_t width = 4;
+    __m256d v;
+    static Vec load(const double* p) { return {_mm256_loadu_pd(p)}; }
+    static Vec set1(double s) { return {_mm256_set1_pd(s)}; }
+    void store(double* p) const { _mm256_storeu_pd(p, v); }
+    Vec operator+(const Vec& o) const { return {_mm256_add_pd(v, o.v)}; }
+    Vec operator-(const Vec& o) const { return {_mm256_sub_pd(v, o.v)}; }
+    Vec operator*(const Vec& o) const { return {_mm256_mul_pd(v, o.v)}; }
+};
+
+template <>
+struct Vec<float> {
+    static constexpr std::size_t width = 8;
+    __m256 v;
+    static Vec load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static Vec set1(float s) { return {_mm256_set1_ps(s)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    Vec operator+(const Vec& o) const { return {_mm256_add_ps(v, o.v)}; }
+    Vec operator-(const Vec& o) const { return {_mm256_sub_ps(v, o.v)}; }
+    Vec operator*(const Vec& o) const { return {_mm256_mul_ps(v, o.v)}; }
+};
+#elif defined(__SSE2__)
+template <>
+struct Vec<double> {
+    static constexpr std::size_t width = 2;
+    __m128d v;
+    static Vec load(const double* p) { return {_mm_loadu_pd(p)}; }
+    static Vec set1(double s) { return {_mm_set1_pd(s)}; }
+    void store(double* p) const { _mm_storeu_pd(p, v); }
+    Vec operator+(const Vec& o) const { return {_mm_add_pd(v, o.v)}; }
+    Vec operator-(const Vec& o) const { return {_mm_sub_pd(v, o.v)}; }
+    Vec operator*(const Vec& o) const { return {_mm_mul_pd(v, o.v)}; }
+};
+
+template <>
+struct Vec<float> {
+    static constexpr std::size_t width = 4;
+    __m128 v;
+    static Vec load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static Vec set1(float s) { return {_mm_set1_ps(s)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    Vec operator+(const Vec& o) const { return {_mm_add_ps(v, o.v)}; }
+    Vec operator-(const Vec& o) const { return {_mm_sub_ps(v, o.v)}; }
+    Vec operator*(const Vec& o) const { return {_mm_mul_ps(v, o.v)}; }
+};
+#elif defined(__ARM_NEON)
+#if defined(__aarch64__) // double lanes only exist on AArch64
+template <>
+struct Vec<double> {
+    static constexpr std::size_t width = 2;
+    float64x2_t v;
+    static Vec load(const double* p) { return {vld1q_f64(p)}; }
+    static Vec set1(double s) { return {vdupq_n_f64(s)}; }
+    void store(double* p) const { vst1q_f64(p, v); }
+    Vec operator+(const Vec& o) const { return {vaddq_f64(v, o.v)}; }
+    Vec operator-(const Vec& o) const { return {vsubq_f64(v, o.v)}; }
+    Vec operator*(const Vec& o) const { return {vmulq_f64(v, o.v)}; }
+};
+#endif
+
+template <>
+struct Vec<float> {
+    static constexpr std::size_t width = 4;
+    float32x4_t v;
+    static Vec load(const float* p) { return {vld1q_f32(p)}; }
+    static Vec set1(float s) { return {vdupq_n_f32(s)}; }
+    void store(float* p) const { vst1q_f32(p, v); }
+    Vec operator+(const Vec& o) const { return {vaddq_f32(v, o.v)}; }
+    Vec operator-(const Vec& o) const { return {vsubq_f32(v, o.v)}; }
+    Vec operator*(const Vec& o) const { return {vmulq_f32(v, o.v)}; }
+};
+#endif
+
+} // namespace butterworth_simd
+
+// Runs a cascade of second-order sections on Lanes independent signals, e.g. the three axes of a
+// sensor. Coefficients and state are kept per lane as structure-of-arrays, so that one vector
+// instruction advances several lanes of the same section, even with different coefficients.
+template <std::size_t Lanes, typename T = double>
+class ButterworthIIRBank {
+    using Vec = butterworth_simd::Vec<T>;
+
+public:
+    static constexpr std::size_t lanes = Lanes;
+
+    ButterworthIIRBank() = default;
+
+    explicit ButterworthIIRBank(const IIR_SOST<T>& c) { // Initialize with given sections
+        setCoeffs(c);
+    }
+
+    void setCoeffs(const IIR_SOST<T>& c) { // Same sections on all lanes
+        setCoeffs(&c, 1);
+    }
+
+    // Lanes are split into group_count equal groups, and group g is filtered with groups[g], e.g. the
+    // axes of two sensors with different cutoffs. Coefficients are per lane, so the groups still share
+    // every vector operation. The bank runs the highest order of all groups, and lower orders are
+    // padded with leading pass-through sections, so every group ends in the bank's last section.
+    // With group_lanes, lanes are split into runs of that many that take groups[] in turn, e.g. the
+    // gyro and accelerometer axes of several IMUs with group_count 2 and group_lanes 3.
+    void setCoeffs(const IIR_SOST<T> groups[], std::size_t group_count, std::size_t group_lanes = 0) {
+        setCoeffs(groups, nullptr, group_count, group_lanes);
+    }
+
+    // Same, and the derivative of every lane in the same pass: derivatives[g] is groups[g] with the
+    // numerator of its last section replaced, see butter_derivative(). The last section then runs in
+    // direct form II, whose state is shared by both numerators, so the derivative costs three
+    // multiplies per lane. processBuffer() writes it next to the filtered output.
+    void setCoeffs(const IIR_SOST<T> groups[], const IIR_SOST<T> derivatives[], std::size_t group_count,
+                   std::size_t group_lanes = 0) {
+        assign(groups, derivatives, group_count, group_lanes);
+        reset(T(0));
+    }
+
+    // Replace the coefficients of every group and keep the state, e.g. to move a tracking notch
+    // between two samples; the order and the derivative setting must stay the same. Unlike
+    // setCoeffs() followed by reset(), the signal content in the state carries over.
+    void retune(const IIR_SOST<T> groups[], std::size_t group_count, std::size_t group_lanes = 0) {
+        const std::size_t sections = sections_;
+        assign(groups, nullptr, group_count, group_lanes);
+        assert(sections_ == sections && !derivative_);
+        (void)sections;
+    }
+
+    void reset(T value = 0) { // Reset all lanes to the steady state of a constant input
+        T values[Lanes];
+        for (std::size_t l = 0; l < Lanes; ++l) values[l] = value;
+        reset(values);
+    }
+
+    void reset(const T values[Lanes]) { // Reset each lane to the steady state of its own constant input
+        reset(values, 0, kPadded);
+    }
+
+    // Reset lanes first to first + count - 1 only and keep the state of the others, e.g. to restart
+    // one of several IMUs after a dropout. Each section settles at its DC gain B(1) / A(1), taken
+    // from the coefficients as stored, times its input, so the output is exact for any section,
+    // including a derivative whose gain is zero, and does not drift by the rounding of the gain.
+    void reset(const T values[Lanes], std::size_t first, std::size_t count) {
+        for (std::size_t l = first; l < first + count && l < kPadded; ++l) {
+            T v = l < Lanes ? values[l] : 0;
+            for (std::size_t i = 0; i < BUTTERWORTH_MAX_SECTIONS && step_ != nullptr; ++i) {
+                const T b = b_[i][0][l] + b_[i][1][l] + b_[i][2][l];
+                const T a = a_[i][0][l] + a_[i][1][l] + a_[i][2][l];
+                if (derivative_ && i + 1 == sections_) { // direct form II, both delayed w settle at v / A(1)
+                    z0_[i][l] = v / a;
+                    z1_[i][l] = z0_[i][l];
+                    v = b * z0_[i][l];
+                    continue;
+                }
+                const T y = v * b / a;
+                z1_[i][l] = b_[i][2][l] * v - a_[i][2][l] * y;
+                z0_[i][l] = b_[i][1][l] * v - a_[i][1][l] * y + z1_[i][l];
+                v = y; // output of this section feeds the next one
+            }
+            if (l < Lanes) y_[l] = v;
+        }
+    }
+
+    void process(const T in[Lanes], T out[Lanes]) { // Advance all lanes by one sample
+        processBuffer(in, out, 1);
+    }
+
+    // Advance all lanes by n samples. in and out hold n rows of Lanes values and may alias. The
+    // samples are filtered in passes of up to kRows, one section at a time, so each section's state
+    // and coefficients stay in registers for the whole pass instead of being reloaded per sample.
+    // Without padding lanes the rows are filtered in place in out, otherwise through a block of at
+    // most 32 values on the stack.
+    void processBuffer(const T* in, T* out, std::size_t n) {
+        if (step_ == nullptr && !derivative_) {
+            for (std::size_t i = 0; i < n * Lanes; ++i) out[i] = in[i];
+        } else if (kPadded == Lanes && !derivative_) {
+            if (out != in) std::memcpy(out, in, n * Lanes * sizeof(T));
+            for (std::size_t start = 0; start < n; start += kRows) {
+                (this->*step_)(out + start * Lanes, n - start < kRows ? n - start : kRows);
+            }
+        } else { // the derivative nobody asked for is dropped in the block
+            processBlocks(in, out, nullptr, n);
+        }
+
+        if (n > 0) {
+            for (std::size_t l = 0; l < Lanes; ++l) y_[l] = out[(n - 1) * Lanes + l];
+        }
+    }
+
+    // Advance all lanes by n samples and write the derivative of every output row to derivative,
+    // which may alias in but not out. Requires coefficients set with derivatives. As above, the
+    // rows are filtered in place and the derivative is written straight to derivative unless the
+    // lanes need padding.
+    void processBuffer(const T* in, T* out, T* derivative, std::size_t n) {
+        assert(derivative_ && derivative_step_ != nullptr);
+        if (kPadded == Lanes) {
+            if (out != in) std::memcpy(out, in, n * Lanes * sizeof(T));
+            for (std::size_t start = 0; start < n; start += kRows) {
+                (this->*derivative_step_)(out + start * Lanes, derivative + start * Lanes, n - start < kRows ? n - start : kRows);
+            }
+        } else {
+            processBlocks(in, out, derivative, n);
+        }
+
+        if (n > 0) {
+            for (std::size_t l = 0; l < Lanes; ++l) y_[l] = out[(n - 1) * Lanes + l];
+        }
+    }
+
+    bool hasDerivative() const { return derivative_; }
+
+    // Last output of each lane. Warm-start new coefficients with setCoeffs() followed by
+    // reset() from a copy of these, so that the output continues without a step.
+    const T* output() const { return y_; }
+
+private:
+    void assign(const IIR_SOST<T> groups[], const IIR_SOST<T> derivatives[], std::size_t group_count, std::size_t group_lanes) {
+        if (group_lanes == 0) group_lanes = Lanes / group_count;
+        assert(group_count >= 1 && group_lanes >= 1 && Lanes % (group_count * group_lanes) == 0);
+        int order = 0;
+        for (std::size_t g = 0; g < group_count; ++g) {
+            const IIR_SOST<T>& c = groups[g];
+            assert(c.sections >= 1 && c.sections <= BUTTERWORTH_MAX_SECTIONS);
+            assert(c.order >= 1 && c.order <= BUTTERWORTH_MAX_ORDER);
+            assert(c.order % 2 == 0 || (c.s[0].a[2] == 0 && c.s[0].b[2] == 0)); // odd orders start with the real pole
+            order = c.order > order ? c.order : order;
+        }
+        sections_ = static_cast<std::size_t>(order + 1) / 2;
+        derivative_ = derivatives != nullptr;
+        step_ = stepForOrder(order, std::make_index_sequence<BUTTERWORTH_MAX_ORDER>{});
+        derivative_step_ = derivativeStepForOrder(order, std::make_index_sequence<BUTTERWORTH_MAX_ORDER>{});
+
+        for (std::size_t l = 0; l < kPadded; ++l) { // copy sections per lane, padding lanes pass through
+            const std::size_t g = l / group_lanes % group_count;
+            const IIR_SOST<T>* c = l < Lanes ? &groups[g] : nullptr;
+            // sections are aligned at the end; in an odd-order bank only section 0 is first order,
+            // and an even order never reaches it because it has fewer sections
+            const std::size_t first = c != nullptr ? sections_ - static_cast<std::size_t>(c->sections) : sections_;
+            for (std::size_t i = 0; i < BUTTERWORTH_MAX_SECTIONS; ++i) {
+                for (std::size_t k = 0; k < 3; ++k) {
+                    const bool used = i >= first && i < sections_;
+                    b_[i][k][l] = used ? c->s[i - first].b[k] : (k == 0 ? 1 : 0);
+                    a_[i][k][l] = used ? c->s[i - first].a[k] : (k == 0 ? 1 : 0);
+                }
+            }
+            assert(!derivative_ || c == nullptr || derivatives[g].sections == c->sections);
+            for (std::size_t k = 0; k < 3; ++k) { // padding lanes have a zero derivative
+                d_[k][l] = derivative_ && c != nullptr ? derivatives[g].s[c->sections - 1].b[k] : 0;
+            }
+        }
+    }
+
+    // Filter n rows through blocks of kBlock rows on the stack, which have the padding lanes the
+    // sections expect. With a derivative bank, the derivative is written to derivative unless it is
+    // null. Both processBuffer() overloads share this one pair of blocks.
+    void processBlocks(const T* in, T* out, T* derivative, std::size_t n) {
+        alignas(32) T x[kBlock * kPadded];
+        alignas(32) T dx[kBlock * kPadded];
+        for (std::size_t start = 0; start < n; start += kBlock) {
+            const std::size_t m = n - start < kBlock ? n - start : kBlock;
+            for (std::size_t t = 0; t < m; ++t) {
+                for (std::size_t l = 0; l < kPadded; ++l) x[t * kPadded + l] = l < Lanes ? in[(start + t) * Lanes + l] : 0;
+            }
+            if (derivative_) {
+                (this->*derivative_step_)(x, dx, m);
+            } else {
+                (this->*step_)(x, m);
+            }
+            for (std::size_t t = 0; t < m; ++t) {
+                for (std::size_t l = 0; l < Lanes; ++l) {
+                    out[(start + t) * Lanes + l] = x[t * kPadded + l];
+                    if (derivative != nullptr) derivative[(start + t) * Lanes + l] = dx[t * kPadded + l];
+                }
+            }
+        }
+    }
+
+    using StepFn = void (ButterworthIIRBank::*)(T x[], std::size_t n);
+    using DerivativeStepFn = void (ButterworthIIRBank::*)(T x[], T dx[], std::size_t n);
+
+    // lanes rounded up to a whole number of vectors, the padding lanes are filtered but never read
+    static constexpr std::size_t kPadded = (Lanes + Vec::width - 1) / Vec::width * Vec::width;
+    // samples per pass of the sections in processBuffer, one full IMU FIFO
+    static constexpr std::size_t kRows = 32;
+    // samples per block copied through the stack when the rows need padding lanes, at most 32 values,
+    // so that filtering one sample fits the stack of a low-priority work queue
+    static constexpr std::size_t kBlock = kPadded >= 32 ? 1 : 32 / kPadded;
+
+    template <std::size_t... N>
+    static StepFn stepForOrder(int order, std::index_sequence<N...>) { // dispatch table over orders 1..BUTTERWORTH_MAX_ORDER
+        static const StepFn table[] = {&ButterworthIIRBank::processOrder<static_cast<int>(N) + 1>...};
+        return table[order - 1];
+    }
+
+    template <std::size_t... N>
+    static DerivativeStepFn derivativeStepForOrder(int order, std::index_sequence<N...>) {
+        static const DerivativeStepFn table[] = {&ButterworthIIRBank::processOrderDerivative<static_cast<int>(N) + 1>...};
+        return table[order - 1];
+    }
+
+    template <int N>
+    void processOrder(T x[], std::size_t n) { // all sections of an order N filter, unrolled
+        processSections<N % 2 == 1>(x, n, std::make_index_sequence<(N + 1) / 2>{});
+    }
+
+    template <int N>
+    void processOrderDerivative(T x[], T dx[], std::size_t n) { // the last section also writes the derivative
+        constexpr std::size_t S = (N + 1) / 2;
+        processSections<N % 2 == 1>(x, n, std::make_index_sequence<S - 1>{});
+        processDerivativeSection<S - 1>(x, dx, n);
+    }
+
+    template <bool OddOrder, std::size_t... I>
+    void processSections(T x[], std::size_t n, std::index_sequence<I...>) {
+        (void)x; // unused when there is no section before the derivative section
+        (void)n;
+        using expand = int[];
+        (void)expand{0, (processSection<I, OddOrder && I == 0>(x, n), 0)...};
+    }
+
+    // One section on all lanes of n samples, x holds n rows of kPadded values. The vectors of a
+    // section are independent of each other, so their updates overlap. The real pole of an odd
+    // order sits in section 0 and skips its zero taps.
+    template <std::size_t I, bool FirstOrder>
+    void processSection(T x[], std::size_t n) {
+        for (std::size_t l = 0; l < kPadded; l += Vec::width) {
+            const Vec b0 = Vec::load(&b_[I][0][l]), b1 = Vec::load(&b_[I][1][l]), a1 = Vec::load(&a_[I][1][l]);
+            const Vec b2 = Vec::load(&b_[I][2][l]), a2 = Vec::load(&a_[I][2][l]);
+            Vec z0 = Vec::load(&z0_[I][l]);
+            Vec z1 = Vec::load(&z1_[I][l]);
+            for (std::size_t t = 0; t < n; ++t) {
+                T* row = &x[t * kPadded + l];
+                const Vec v = Vec::load(row);
+                const Vec y = b0 * v + z0;
+                if (FirstOrder) {
+                    z0 = b1 * v - a1 * y;
+                } else {
+                    z0 = b1 * v - a1 * y + z1;
+                    z1 = b2 * v - a2 * y;
+                }
+                y.store(row); // output of this section feeds the next one
+            }
+            z0.store(&z0_[I][l]);
+            z1.store(&z1_[I][l]);
+        }
+    }
+
+    // Last section in direct form II: w = v - a1 w1 - a2 w2, the output is b.(w, w1, w2) and the
+    // derivative d.(w, w1, w2). z0_ and z1_ hold w1 and w2. A first-order section has zero a2, b2, d2.
+    template <std::size_t I>
+    void processDerivativeSection(T x[], T dx[], std::size_t n) {
+        for (std::size_t l = 0; l < kPadded; l += Vec::width) {
+            const Vec b0 = Vec::load(&b_[I][0][l]), b1 = Vec::load(&b_[I][1][l]), b2 = Vec::load(&b_[I][2][l]);
+            const Vec a1 = Vec::load(&a_[I][1][l]), a2 = Vec::load(&a_[I][2][l]);
+            const Vec d0 = Vec::load(&d_[0][l]), d1 = Vec::load(&d_[1][l]), d2 = Vec::load(&d_[2][l]);
+            Vec w1 = Vec::load(&z0_[I][l]);
+            Vec w2 = Vec::load(&z1_[I][l]);
+            for (std::size_t t = 0; t < n; ++t) {
+                T* row = &x[t * kPadded + l];
+                const Vec w = Vec::load(row) - a1 * w1 - a2 * w2;
+                (b0 * w + b1 * w1 + b2 * w2).store(row);
+                (d0 * w + d1 * w1 + d2 * w2).store(&dx[t * kPadded + l]);
+                w2 = w1;
+                w1 = w;
+            }
+            w1.store(&z0_[I][l]);
+            w2.store(&z1_[I][l]);
+        }
+    }
+
+    T b_[BUTTERWORTH_MAX_SECTIONS][3][kPadded] = {}; // coefficients of each section, per lane
+    T a_[BUTTERWORTH_MAX_SECTIONS][3][kPadded] = {};
+    T z0_[BUTTERWORTH_MAX_SECTIONS][kPadded] = {}; // first state word of each section, per lane
+    T z1_[BUTTERWORTH_MAX_SECTIONS][kPadded] = {}; // second state word of each section, per lane
+    T d_[3][kPadded] = {}; // derivative numerator of the last section, per lane
+    T y_[Lanes] = {}; // last output row
+    std::size_t sections_ = 0; // Number of sections between 1 and BUTTERWORTH_MAX_SECTIONS
+    bool derivative_ = false; // last section in direct form II with the derivative numerator d_
+    StepFn step_ = nullptr; // specialized update for the configured order
+    DerivativeStepFn derivative_step_ = nullptr;
+};
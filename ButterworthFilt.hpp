@@ -3,72 +3,130 @@
 #pragma once
 #include "ButterworthSynth.hpp"
 
-class ButterworthIIR { // Implements a direct-form IIR filter
+template <typename T>
+class ButterworthIIRT { // Implements a transposed direct form II IIR filter
 public:
-    ButterworthIIR() = default;
+    ButterworthIIRT() = default;
 
-    explicit ButterworthIIR(const IIR_Coeffs& c) { // Initialize with given coefficients
+    explicit ButterworthIIRT(const IIR_CoeffsT<T>& c) { // Initialize with given coefficients
         setCoeffs(c);
     }
 
-    void setCoeffs(const IIR_Coeffs& c) {
+    void setCoeffs(const IIR_CoeffsT<T>& c) {
         assert(c.order >= 1 && c.order <= BUTTERWORTH_MAX_ORDER);
         order_ = static_cast<std::size_t>(c.order);
 
         for (std::size_t i = 0; i <= order_; ++i) {  // copy coefficients
             a_[i] = c.a[i];
             b_[i] = c.b[i];
-            xHist_[i] = 0.0;
-            yHist_[i] = 0.0;
         }
 
-        for (std::size_t i = order_ + 1; i < BUTTERWORTH_MAX_COEFFS; ++i) { // zero unused coefficients and history
-            a_[i] = 0.0;
-            b_[i] = 0.0;
-            xHist_[i] = 0.0;
-            yHist_[i] = 0.0;
+        for (std::size_t i = order_ + 1; i < BUTTERWORTH_MAX_COEFFS; ++i) { // zero unused coefficients
+            a_[i] = 0;
+            b_[i] = 0;
         }
+
+        for (std::size_t i = 0; i < BUTTERWORTH_MAX_ORDER; ++i) z_[i] = 0;
     }
 
-    void reset(double value = 0.0) { // Reset history to specified value
+    void reset(T value = 0) { // Reset state to the steady state of a constant input
         if (order_ == 0) return;
+        // the output settles at value times the DC gain B(1) / A(1) of the stored coefficients,
+        // and z_[i] collects the remaining taps
+        T b = 0, a = 0;
         for (std::size_t i = 0; i <= order_; ++i) {
-            xHist_[i] = value;
-            yHist_[i] = value;
+            b += b_[i];
+            a += a_[i];
+        }
+        const T y = value * b / a;
+        T acc = 0;
+        for (std::size_t i = order_; i > 0; --i) {
+            acc += b_[i] * value - a_[i] * y;
+            z_[i - 1] = acc;
         }
     }
 
-    double process(double x) {
+    T process(T x) {
         if (order_ == 0) return x;
-        // shift history (xHist_[0] is newest)
-        for (std::size_t i = order_; i > 0; --i) xHist_[i] = xHist_[i - 1];
-        xHist_[0] = x;
-
-        double y = 0.0;
-        // feedforward
-        // coefficients are stored highest-order-first: b_[0] corresponds to x[n-order]
-        for (std::size_t k = 0; k <= order_; ++k)
-            y += b_[k] * xHist_[order_ - k];
-
-        // feedback (skip a[0] which is the leading coefficient)
-        // a_[k] corresponds to coefficient for y[n - (order_ - k)] so map to yHist_[order_ - k]
-        for (std::size_t k = 1; k <= order_; ++k)
-            y -= a_[k] * yHist_[order_ - k];
-        // shift y history
-        for (std::size_t i = order_; i > 0; --i) yHist_[i] = yHist_[i - 1];
-        yHist_[0] = y;
+        // b_[k] and a_[k] are the coefficients of x[n-k] and y[n-k], a_[0] is the leading 1
+        // z_[k] holds the contribution of past samples to y[n+k], so no history is shifted
+        const T y = b_[0] * x + z_[0];
+        const std::size_t last = order_ - 1;
+        for (std::size_t k = 0; k < last; ++k)
+            z_[k] = b_[k + 1] * x - a_[k + 1] * y + z_[k + 1];
+        z_[last] = b_[order_] * x - a_[order_] * y;
 
         return y;
     }
 
-    void processBuffer(const double* in, double* out, std::size_t n) {
+    void processBuffer(const T* in, T* out, std::size_t n) {
         for (std::size_t i = 0; i < n; ++i) out[i] = process(in[i]);
     }
 
 private:
-    double a_[BUTTERWORTH_MAX_COEFFS] = {}; 
-    double b_[BUTTERWORTH_MAX_COEFFS] = {};
-    double xHist_[BUTTERWORTH_MAX_COEFFS] = {}; // history for feedforward (input)
-    double yHist_[BUTTERWORTH_MAX_COEFFS] = {}; // history for feedback (output)
+    T a_[BUTTERWORTH_MAX_COEFFS] = {}; 
+    T b_[BUTTERWORTH_MAX_COEFFS] = {};
+    T z_[BUTTERWORTH_MAX_ORDER] = {}; // transposed direct form II state, one word per order
     std::size_t order_ = 0; // Filter order between 1 and BUTTERWORTH_MAX_ORDER
 };
+
+template <typename T>
+class ButterworthSOST { // Implements a cascade of second-order sections, each in transposed direct form II
+public:
+    ButterworthSOST() = default;
+
+    explicit ButterworthSOST(const IIR_SOST<T>& c) { // Initialize with given sections
+        setCoeffs(c);
+    }
+
+    void setCoeffs(const IIR_SOST<T>& c) {
+        assert(c.sections >= 1 && c.sections <= BUTTERWORTH_MAX_SECTIONS);
+        sections_ = static_cast<std::size_t>(c.sections);
+
+        for (std::size_t i = 0; i < BUTTERWORTH_MAX_SECTIONS; ++i) { // copy sections, unused ones stay zero
+            for (std::size_t k = 0; k < 3; ++k) {
+                b_[i][k] = i < sections_ ? c.s[i].b[k] : 0;
+                a_[i][k] = i < sections_ ? c.s[i].a[k] : 0;
+            }
+            z_[i][0] = 0;
+            z_[i][1] = 0;
+        }
+    }
+
+    void reset(T value = 0) { // Reset state to the steady state of a constant input
+        // each section settles at its DC gain B(1) / A(1) times its input, which is one for the
+        // low-pass sections and zero for a derivative
+        for (std::size_t i = 0; i < sections_; ++i) {
+            const T y = value * (b_[i][0] + b_[i][1] + b_[i][2]) / (a_[i][0] + a_[i][1] + a_[i][2]);
+            z_[i][1] = b_[i][2] * value - a_[i][2] * y;
+            z_[i][0] = b_[i][1] * value - a_[i][1] * y + z_[i][1];
+            value = y; // output of this section feeds the next one
+        }
+    }
+
+    T process(T x) {
+        if (sections_ == 0) return x;
+        for (std::size_t i = 0; i < sections_; ++i) {
+            const T y = b_[i][0] * x + z_[i][0];
+            z_[i][0] = b_[i][1] * x - a_[i][1] * y + z_[i][1];
+            z_[i][1] = b_[i][2] * x - a_[i][2] * y;
+            x = y; // output of this section feeds the next one
+        }
+        return x;
+    }
+
+    void processBuffer(const T* in, T* out, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = process(in[i]);
+    }
+
+private:
+    T b_[BUTTERWORTH_MAX_SECTIONS][3] = {};
+    T a_[BUTTERWORTH_MAX_SECTIONS][3] = {};
+    T z_[BUTTERWORTH_MAX_SECTIONS][2] = {}; // transposed direct form II state of each section
+    std::size_t sections_ = 0; // Number of sections between 1 and BUTTERWORTH_MAX_SECTIONS
+};
+
+using ButterworthIIR = ButterworthIIRT<double>;
+using ButterworthIIRf = ButterworthIIRT<float>;
+using ButterworthSOS = ButterworthSOST<double>;
+using ButterworthSOSf = ButterworthSOST<float>;
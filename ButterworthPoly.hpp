@@ -0,0 +1,178 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+// Modified version of https://thecodehound.com/butterworth-filter-design-in-c/
+
+// Pole placement and polynomial expansion shared by butter_synth() and its constexpr variant.
+// Everything is constexpr and parameterized on a Trig policy providing sin, cos and tan, so the
+// same code runs with libm at runtime and with series expansions at compile time. The sample
+// type T is deduced from the frequencies, and all arithmetic stays in T.
+
+#pragma once
+
+#include "ButterworthSynth.hpp"
+#include <cstddef>
+
+namespace butterworth_detail {
+
+template <typename T>
+struct Cplx { // Struct to imiatate std::complex
+    T re{0}, im{0};
+    constexpr Cplx() = default;
+    constexpr Cplx(const Cplx& o) = default;
+    constexpr Cplx(T r, T i=0): re(r), im(i) {}
+    constexpr Cplx operator+(const Cplx& o) const { return {re + o.re, im + o.im}; }
+    constexpr Cplx operator+(const T& o) const { return {re + o, im}; }
+    constexpr Cplx& operator+=(const Cplx& o) { re += o.re; im += o.im; return *this; }
+    constexpr Cplx operator-(const Cplx& o) const { return {re - o.re, im - o.im}; }
+    constexpr Cplx& operator=(const Cplx& o) { re = o.re; im = o.im; return *this; }
+    constexpr Cplx& operator=(T r) { re = r; im = 0; return *this; }
+    constexpr Cplx operator-() const { return {-re, -im}; }
+    constexpr Cplx operator*(const Cplx& o) const { return {re*o.re - im*o.im, re*o.im + im*o.re}; }
+    constexpr Cplx operator*=(const T& r) { re *= r; im *= r; return *this; }
+    constexpr Cplx operator/(const Cplx& o) const {
+        T d = o.re*o.re + o.im*o.im;
+        return {(re*o.re + im*o.im)/d, (im*o.re - re*o.im)/d};
+    }
+    constexpr Cplx conj() const { return {re, -im}; }
+    constexpr T real() const { return re; }
+};
+
+template <typename T>
+struct Poly { // Struct to represent a polynomial
+	Cplx<T> c[BUTTERWORTH_MAX_COEFFS]; // Coefficients in lowest-order-first form
+	size_t size = 1; // Number of coefficients
+	constexpr Poly() {
+		for (size_t i = 0; i < BUTTERWORTH_MAX_COEFFS; ++i) c[i] = Cplx<T>(0);
+		c[0] = Cplx<T>(1);
+	}
+};
+
+template <typename T>
+constexpr Poly<T> multiply(const Poly<T>& p, const Poly<T>& q) // Multiply two polynomials
+{
+	Poly<T> result;
+	result.c[0] = Cplx<T>(0); // start from the zero polynomial, not from 1
+	result.size = p.size + q.size - 1;
+	assert(result.size <= BUTTERWORTH_MAX_COEFFS);
+	for (size_t i = 0; i < p.size; i++)
+		for (size_t j = 0; j < q.size; j++)
+			result.c[i + j] += p.c[i] * q.c[j];
+	return result;
+}
+
+// Calculate the coefficients of the polynomial with the specified roots.
+template <typename T>
+constexpr Poly<T> poly(const Cplx<T> roots[], size_t N)
+{
+	Poly<T> result;
+	for (size_t i = 0; i < N; ++i)
+	{
+		Poly<T> factor;
+		factor.c[0] = -roots[i];
+		factor.c[1] = Cplx<T>(1);
+		factor.size = 2;
+		result = multiply(result, factor); // multiply each root equation into result to have the full polynomial
+	}
+	return result;
+}
+
+template <typename T>
+constexpr Cplx<T> sum(const Poly<T>& p) // Sum of polynomial coefficients
+{
+	Cplx<T> s = Cplx<T>(0);
+	for (size_t i = 0; i < p.size; ++i) s += p.c[i];
+	return s;
+}
+
+// Taken from: https://www.dsprelated.com/showarticle/1119.php
+// Digital poles of an order N Butterworth low-pass filter, written to p[0..N-1].
+// p[i] and p[N-1-i] are complex conjugates, and p[(N-1)/2] is real when N is odd.
+template <class Trig, typename T>
+constexpr void butter_poles(int N, T fc, T fs, Cplx<T> p[])
+{
+	const T pi = static_cast<T>(M_PI);
+	Cplx<T> pa[BUTTERWORTH_MAX_ORDER]; // Analog filter poles. Analog Butterworth filter has no zeros.
+
+	// I. Find poles of analog filter for normalized cutoff frequency of 1 rad/s
+	for (int i = 0; i < N; i++)
+	{
+		int k = i + 1;
+		T theta = (2 * k - 1) * pi / (2 * N);
+		pa[i] = Cplx<T>(-Trig::sin(theta), Trig::cos(theta));
+	}
+
+	// II. Scale poles in frequency
+	T Fc = fs / pi * Trig::tan(pi * fc / fs); // Fc is the analog cutoff frequency for a given digital cutoff frequency fc and sampling frequency fs
+	for (size_t i = 0; i < static_cast<size_t>(N); i++)
+		pa[i] *= 2 * pi * Fc; // Scaled analog filter poles
+
+	// III. Find digital filter poles in the z plane using bilinear transform
+	for (size_t i = 0; i < static_cast<size_t>(N); i++)
+		p[i] = (Cplx<T>(1) + pa[i] / Cplx<T>(2 * fs)) / (Cplx<T>(1) - pa[i] / Cplx<T>(2 * fs));
+}
+
+template <class Trig, typename T>
+constexpr IIR_CoeffsT<T> butter_synth(int N, T fc, T fs)
+{
+	assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER);
+	IIR_CoeffsT<T> coeffs;
+
+	Cplx<T> p[BUTTERWORTH_MAX_ORDER]; // Digital filter poles.
+	Cplx<T> q[BUTTERWORTH_MAX_ORDER]; // Digital filter zeros.
+	for (size_t i = 0; i < BUTTERWORTH_MAX_ORDER; ++i) q[i] = Cplx<T>(-1); // All zeros at z = -1
+
+	butter_poles<Trig>(N, fc, fs, p);
+
+	auto a_poly = poly(p, static_cast<size_t>(N)); // Generate polynomial from poles p, in lowest-order-first form
+	// Store coefficients highest-order-first: a[0] is coef for z^N, a[N] is constant term
+	for (size_t i = 0; i < a_poly.size; ++i)
+		coeffs.a[i] = a_poly.c[a_poly.size - 1 - i].real();
+
+	auto b_poly = poly(q, static_cast<size_t>(N)); // Numerator polynomial from zeros q, which are all -1, in lowest-order-first form
+	Cplx<T> K = sum(a_poly) / sum(b_poly);
+	for (size_t i = 0; i < b_poly.size; ++i)
+		coeffs.b[i] = (b_poly.c[b_poly.size - 1 - i] * K).real();
+
+	coeffs.order = N;
+	return coeffs;
+}
+
+template <class Trig, typename T>
+constexpr IIR_SOST<T> butter_synth_sos(int N, T fc, T fs)
+{
+	assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER);
+	IIR_SOST<T> sos;
+
+	Cplx<T> p[BUTTERWORTH_MAX_ORDER]; // Digital filter poles.
+	butter_poles<Trig>(N, fc, fs, p);
+
+	// Each section gets its own zeros at z = -1 and unity gain at DC, so no section amplifies
+	// the signal and the overall gain never has to be collected into a single coefficient.
+	// The real pole of an odd order goes first, followed by the pairs ordered from the
+	// lowest to the highest Q, which keeps the peaking of the intermediate signals small.
+	int n = 0;
+	if (N % 2 == 1) {
+		IIR_BiquadT<T>& s = sos.s[n++];
+		s.a[0] = 1;
+		s.a[1] = -p[(N - 1) / 2].real();
+		T g = (1 + s.a[1]) / 2;
+		s.b[0] = g;
+		s.b[1] = g;
+	}
+
+	for (int i = N / 2 - 1; i >= 0; --i) {
+		IIR_BiquadT<T>& s = sos.s[n++];
+		s.a[0] = 1;
+		s.a[1] = -2 * p[i].re;
+		s.a[2] = p[i].re * p[i].re + p[i].im * p[i].im;
+		T g = (1 + s.a[1] + s.a[2]) / 4;
+		s.b[0] = g;
+		s.b[1] = 2 * g;
+		s.b[2] = g;
+	}
+
+	sos.sections = n;
+	sos.order = N;
+	return sos;
+}
+
+} // namespace butterworth_detail
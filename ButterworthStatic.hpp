@@ -0,0 +1,118 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Filters with the order fixed at compile time, and constexpr coefficient synthesis for them.
+// A fixed airframe configuration can bake its coefficients into flash, e.g.
+//     static constexpr IIR_SOS gyro_sos = butter_synth_sos<4>(30.0, 400.0);
+// and run them through ButterworthIIRBank, or use ButterworthIIRStatic<N> for a single signal.
+
+#pragma once
+#include "ButterworthPoly.hpp"
+#include <cstddef>
+#include <utility>
+
+namespace butterworth_detail {
+
+struct ConstexprTrig { // Series trigonometry usable in constant expressions, accurate to a few ulp
+    template <typename T>
+    static constexpr T wrap(T x) { // reduce to [-pi, pi]
+        const T two_pi = static_cast<T>(2 * M_PI);
+        const T turns = x / two_pi;
+        const long long n = static_cast<long long>(turns < 0 ? turns - T(0.5) : turns + T(0.5));
+        return x - static_cast<T>(n) * two_pi;
+    }
+    template <typename T>
+    static constexpr T sin(T x) {
+        x = wrap(x);
+        T term = x, s = x;
+        for (int k = 1; k < 20; ++k) {
+            term *= -x * x / static_cast<T>((2 * k) * (2 * k + 1));
+            s += term;
+        }
+        return s;
+    }
+    template <typename T>
+    static constexpr T cos(T x) {
+        x = wrap(x);
+        T term = 1, c = 1;
+        for (int k = 1; k < 20; ++k) {
+            term *= -x * x / static_cast<T>((2 * k - 1) * (2 * k));
+            c += term;
+        }
+        return c;
+    }
+    template <typename T>
+    static constexpr T tan(T x) { return sin(x) / cos(x); }
+};
+
+} // namespace butterworth_detail
+
+template <int N, typename T = double>
+constexpr IIR_CoeffsT<T> butter_synth(double fc, double fs) // Order N, cutoff freq fc, sampling freq fs
+{
+    static_assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER, "unsupported filter order");
+    return butterworth_detail::butter_synth<butterworth_detail::ConstexprTrig>(N, static_cast<T>(fc), static_cast<T>(fs));
+}
+
+template <int N, typename T = double>
+constexpr IIR_SOST<T> butter_synth_sos(double fc, double fs) // Same filter as butter_synth<N>, split into sections
+{
+    static_assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER, "unsupported filter order");
+    return butterworth_detail::butter_synth_sos<butterworth_detail::ConstexprTrig>(N, static_cast<T>(fc), static_cast<T>(fs));
+}
+
+template <int N, typename T = double>
+class ButterworthIIRStatic { // Transposed direct form II IIR filter of order N, loops fully unrolled
+    static_assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER, "unsupported filter order");
+
+public:
+    ButterworthIIRStatic() = default;
+
+    explicit ButterworthIIRStatic(const IIR_CoeffsT<T>& c) { // Initialize with given coefficients
+        setCoeffs(c);
+    }
+
+    void setCoeffs(const IIR_CoeffsT<T>& c) {
+        assert(c.order == N);
+        for (std::size_t i = 0; i <= N; ++i) {
+            a_[i] = c.a[i];
+            b_[i] = c.b[i];
+            z_[i] = 0;
+        }
+    }
+
+    void reset(T value = 0) { // Reset state to the steady state of a constant input
+        T b = 0, a = 0;
+        for (std::size_t i = 0; i <= N; ++i) {
+            b += b_[i];
+            a += a_[i];
+        }
+        const T y = a != 0 ? value * b / a : value; // DC gain of the stored coefficients
+        T acc = 0;
+        for (std::size_t i = N; i > 0; --i) {
+            acc += b_[i] * value - a_[i] * y;
+            z_[i - 1] = acc;
+        }
+    }
+
+    T process(T x) {
+        const T y = b_[0] * x + z_[0];
+        update(x, y, std::make_index_sequence<N>{});
+        return y;
+    }
+
+    void processBuffer(const T* in, T* out, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) out[i] = process(in[i]);
+    }
+
+private:
+    template <std::size_t... K>
+    void update(T x, T y, std::index_sequence<K...>) {
+        // expands to one statement per state word, in order; z_[N] stays zero
+        using expand = int[];
+        (void)expand{0, (z_[K] = b_[K + 1] * x - a_[K + 1] * y + z_[K + 1], 0)...};
+    }
+
+    T a_[N + 1] = {};
+    T b_[N + 1] = {};
+    T z_[N + 1] = {}; // transposed direct form II state, the last word is a constant zero
+};
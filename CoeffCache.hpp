@@ -0,0 +1,86 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Small cache of synthesized second-order sections, so that switching between coefficient sets
+// that were used before (live tuning, rate adaptation, adaptive cutoffs) is a table lookup
+// instead of trigonometry and polynomial expansion inside the work queue callback. The cache is a
+// fixed array searched linearly, with least-recently-used eviction, and never allocates.
+// Cutoff and sample rate are quantized to fc_step and fs_step before lookup, and entries are
+// synthesized at the quantized values, so a result does not depend on which request created it.
+
+#pragma once
+#include "FilterDesign.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+template <typename T = double, std::size_t Capacity = 8>
+class CoeffCache {
+public:
+    static constexpr std::size_t capacity = Capacity;
+
+    // fc_step and fs_step are the key resolutions in Hz
+    explicit CoeffCache(double fc_step = 0.01, double fs_step = 1.0) : fc_step_(fc_step), fs_step_(fs_step) {}
+
+    // Sections of an order N filter of the given family with cutoff fc and sampling freq fs,
+    // synthesized on a miss. The reference stays valid until the next call to get() or seed().
+    const IIR_SOST<T>& get(FilterFamily family, int N, double fc, double fs) {
+        const int64_t fc_key = std::llround(fc / fc_step_);
+        const int64_t fs_key = std::llround(fs / fs_step_);
+        ++clock_;
+
+        Entry* victim = &entries_[0];
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            Entry& e = entries_[i];
+            if (e.used && e.family == family && e.order == N && e.fc_key == fc_key && e.fs_key == fs_key) {
+                e.stamp = clock_;
+                ++hits_;
+                return e.sos;
+            }
+            // prefer a free entry, otherwise the least recently used one
+            if (victim->used && (!e.used || e.stamp < victim->stamp)) victim = &e;
+        }
+
+        ++misses_;
+        victim->sos = filter_synth_sos<T>(family, N, fc_key * fc_step_, fs_key * fs_step_);
+        victim->family = family;
+        victim->order = N;
+        victim->fc_key = fc_key;
+        victim->fs_key = fs_key;
+        victim->stamp = clock_;
+        victim->used = true;
+        return victim->sos;
+    }
+
+    const IIR_SOST<T>& get(int N, double fc, double fs) { return get(FilterFamily::butterworth, N, fc, fs); }
+
+    void seed(FilterFamily family, int N, double fc, double fs) { // Synthesize ahead of time, e.g. at startup
+        get(family, N, fc, fs);
+    }
+
+    void seed(int N, double fc, double fs) { get(FilterFamily::butterworth, N, fc, fs); }
+
+    void clear() {
+        for (std::size_t i = 0; i < Capacity; ++i) entries_[i].used = false;
+    }
+
+    uint32_t hits() const { return hits_; }
+    uint32_t misses() const { return misses_; }
+
+private:
+    struct Entry {
+        IIR_SOST<T> sos{};
+        int64_t fc_key = 0;
+        int64_t fs_key = 0;
+        uint32_t stamp = 0; // clock_ at the last use
+        FilterFamily family = FilterFamily::butterworth;
+        int order = 0;
+        bool used = false;
+    };
+
+    Entry entries_[Capacity] {};
+    double fc_step_;
+    double fs_step_;
+    uint32_t clock_ = 0;
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+};
@@ -0,0 +1,236 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Tracking notch filters for motor and propeller vibration, placed ahead of the low-pass filters so
+// that the cutoff can stay high. PeakEstimator finds the strongest narrow-band peaks in the angular
+// rate, and DynamicNotch moves up to MAX_NOTCHES notches onto them.
+//
+// The estimator runs a GoertzelBank over the bins of the search band, so every sample costs the
+// same, about one multiply-add per bin and axis, and the only extra work is the peak search at the
+// end of each frame, a median and a pass over the bins. The estimate is refreshed every WINDOW
+// samples, e.g. 0.32 s at 400 Hz, with a bin spacing of fs / WINDOW refined by parabolic
+// interpolation.
+
+#pragma once
+#include "ButterworthBank.hpp"
+#include "Goertzel.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+
+// Notch at f0 with the given -3 dB bandwidth, both in Hz, at sampling freq fs. Unity gain at DC,
+// like every other section, so it can share a cascade with the low-pass sections.
+template <typename T>
+IIR_BiquadT<T> notch_synth(double f0, double bandwidth, double fs)
+{
+    const double alpha = std::tan(M_PI * bandwidth / fs); // exact -3 dB bandwidth of this form
+    const double c = -2 * std::cos(2 * M_PI * f0 / fs);
+    IIR_BiquadT<T> s;
+    s.b[0] = static_cast<T>(1 / (1 + alpha));
+    s.b[1] = static_cast<T>(c / (1 + alpha));
+    s.b[2] = s.b[0];
+    s.a[0] = 1;
+    s.a[1] = s.b[1];
+    s.a[2] = static_cast<T>((1 - alpha) / (1 + alpha));
+    return s;
+}
+
+class PeakEstimator {
+public:
+    static constexpr int WINDOW = 128; // samples per frame
+    static constexpr int MAX_BINS = WINDOW / 2;
+    static constexpr int MAX_PEAKS = 4;
+    static constexpr int AXES = 3;
+    static constexpr float MIN_SNR = 10.f; // a peak's power over the median power in the band
+
+    // Search band [fmin, fmax] in Hz at sampling freq fs, clamped to the bins below 0.45 fs.
+    // Restarts the current frame; the last peaks stay valid until the next one completes.
+    void configure(double fs, double fmin, double fmax) {
+        fs_ = fs;
+        int first = static_cast<int>(std::ceil(fmin * WINDOW / fs));
+        first = first < 1 ? 1 : first;
+        int last = static_cast<int>(std::floor(std::fmin(fmax, 0.45 * fs) * WINDOW / fs));
+        last = last > MAX_BINS - 1 ? MAX_BINS - 1 : last;
+        goertzel_.configure(first, last >= first ? last - first + 1 : 0);
+    }
+
+    int remaining() const { return goertzel_.remaining(); } // Samples until the current frame completes
+
+    // Adds n rows of which the first AXES values are used, stride values apart. n must not exceed
+    // remaining(). Returns true if the last row completed a frame, the peaks are then updated.
+    template <typename T>
+    bool push(const T* rows, std::size_t n, std::size_t stride) {
+        if (!goertzel_.push(rows, n, stride)) return false;
+        findPeaks();
+        return true;
+    }
+
+    int peaks() const { return peaks_; } // Peaks found in the last complete frame
+    float peak(int i) const { return peak_hz_[i]; } // Frequency in Hz, strongest first
+
+private:
+    void findPeaks() {
+        const int bins = goertzel_.bins();
+        float power[MAX_BINS], sorted[MAX_BINS];
+        for (int k = 0; k < bins; ++k) { // summed over the axes, the vibration is on all of them
+            power[k] = 0;
+            for (int a = 0; a < AXES; ++a) power[k] += goertzel_.power(a, k);
+            sorted[k] = power[k];
+        }
+        // the median is the noise floor, unlike the mean it does not rise with the strongest peak
+        std::nth_element(sorted, sorted + bins / 2, sorted + bins);
+        const float floor = bins > 0 ? sorted[bins / 2] : 0;
+
+        // local maxima above the threshold, kept sorted by power, interpolated on the log power
+        peaks_ = 0;
+        float peak_power[MAX_PEAKS];
+        for (int k = 1; k + 1 < bins; ++k) {
+            const float p = power[k];
+            if (!(p > power[k - 1] && p >= power[k + 1] && p > MIN_SNR * floor)) continue;
+            int i = 0;
+            while (i < peaks_ && peak_power[i] >= p) ++i;
+            if (i == MAX_PEAKS) continue; // weaker than all kept peaks
+            peaks_ = peaks_ < MAX_PEAKS ? peaks_ + 1 : MAX_PEAKS;
+            for (int j = peaks_ - 1; j > i; --j) {
+                peak_power[j] = peak_power[j - 1];
+                peak_hz_[j] = peak_hz_[j - 1];
+            }
+            // a neighbour of zero power, from constant or quantized input or an underflow, has no log:
+            // the peak stays on its bin
+            const float l = std::log(std::max(power[k - 1], FLT_MIN)), c = std::log(std::max(p, FLT_MIN)),
+                        r = std::log(std::max(power[k + 1], FLT_MIN));
+            float d = l - 2 * c + r < 0 ? 0.5f * (l - r) / (l - 2 * c + r) : 0.f;
+            d = power[k - 1] > 0 && power[k + 1] > 0 && std::isfinite(d) ? d : 0.f;
+            peak_power[i] = p;
+            peak_hz_[i] = static_cast<float>((goertzel_.first() + k + d) * fs_ / WINDOW);
+        }
+    }
+
+    GoertzelBank<AXES, WINDOW, MAX_BINS> goertzel_ {};
+    float peak_hz_[MAX_PEAKS] = {};
+    double fs_ = 0;
+    int peaks_ = 0;
+};
+
+// Moves count notches with centres center[] in Hz, 0 for a notch not placed yet, onto the peaks of
+// the last frame. Each peak, strongest first, takes the nearest notch not taken yet, or a free one.
+// A notch closer to its peak than the bandwidth moves half way there, which smooths the estimate,
+// and one further away jumps. Centres stay within [fmin, fmax]. Returns false if there was no peak.
+inline bool notch_track(const PeakEstimator& estimator, float center[], int count, double bandwidth, double fmin, double fmax)
+{
+    bool taken[PeakEstimator::MAX_PEAKS] = {};
+    const int peaks = estimator.peaks() < count ? estimator.peaks() : count;
+    for (int p = 0; p < peaks; ++p) {
+        const float f = estimator.peak(p);
+        int best = -1;
+        float best_distance = 0;
+        for (int i = 0; i < count; ++i) {
+            if (taken[i]) continue;
+            const float distance = center[i] > 0 ? std::fabs(center[i] - f) : 1e9f;
+            if (best < 0 || distance < best_distance) {
+                best = i;
+                best_distance = distance;
+            }
+        }
+        taken[best] = true;
+        center[best] = best_distance < bandwidth ? center[best] + 0.5f * (f - center[best]) : f;
+        center[best] = static_cast<float>(std::fmin(std::fmax(center[best], fmin), fmax));
+    }
+    return peaks > 0;
+}
+
+// Up to MAX_NOTCHES notches per lane on the Lanes lanes of a row, of which the first
+// PeakEstimator::AXES feed the estimator. The lanes are runs of AXES that belong to the GROUPS in
+// turn, e.g. the gyro and the accelerometer axes of one or more IMUs. Each group has its notches
+// switched on or off, and all enabled groups follow the same peaks.
+template <std::size_t Lanes, typename T = double>
+class DynamicNotch {
+public:
+    static constexpr int MAX_NOTCHES = PeakEstimator::MAX_PEAKS;
+    static constexpr std::size_t GROUPS = 2;
+
+    // count notches of the given bandwidth searching [fmin, fmax], all in Hz, at sampling freq fs.
+    // Notches already placed stay where they are, clamped to the new band.
+    void configure(int count, const bool enabled[GROUPS], double fmin, double fmax, double bandwidth, double fs) {
+        count_ = count < 0 ? 0 : (count > MAX_NOTCHES ? MAX_NOTCHES : count);
+        for (std::size_t g = 0; g < GROUPS; ++g) enabled_[g] = enabled[g];
+        fmin_ = fmin;
+        fmax_ = fmax;
+        bandwidth_ = bandwidth;
+        fs_ = fs;
+        for (int i = 0; i < MAX_NOTCHES; ++i) {
+            if (center_[i] > 0) center_[i] = std::fmin(std::fmax(center_[i], fmin), fmax);
+        }
+        estimator_.configure(fs, fmin, fmax);
+
+        if (!active()) return;
+        IIR_SOST<T> groups[GROUPS];
+        design(groups);
+        T out[Lanes];
+        for (std::size_t l = 0; l < Lanes; ++l) out[l] = bank_.output()[l];
+        bank_.setCoeffs(groups, GROUPS, PeakEstimator::AXES);
+        bank_.reset(out);
+    }
+
+    bool active() const { return count_ > 0 && (enabled_[0] || enabled_[1]); }
+
+    // Reset lanes first to first + count - 1 to the steady state of their own constant input values
+    void reset(const T values[Lanes], std::size_t first, std::size_t count) {
+        if (active()) bank_.reset(values, first, count);
+    }
+
+    const T* output() const { return bank_.output(); } // Last notched row, while active
+
+    // Notch n rows in place, updating the estimate as they pass; a frame completed by a row moves the
+    // notches from the next row on
+    void processBuffer(T* x, std::size_t n) {
+        if (!active()) return;
+        std::size_t done = 0;
+        while (done < n) {
+            const std::size_t m = n - done < static_cast<std::size_t>(estimator_.remaining()) ? n - done : estimator_.remaining();
+            const bool update = estimator_.push(x + done * Lanes, m, Lanes);
+            bank_.processBuffer(x + done * Lanes, x + done * Lanes, m);
+            if (update) track();
+            done += m;
+        }
+    }
+
+    int count() const { return count_; }
+    float center(int i) const { return center_[i]; } // Centre frequency in Hz, 0 until a peak is found
+    const PeakEstimator& estimator() const { return estimator_; }
+
+private:
+    void track() {
+        if (!notch_track(estimator_, center_, count_, bandwidth_, fmin_, fmax_)) return;
+        IIR_SOST<T> groups[GROUPS];
+        design(groups);
+        bank_.retune(groups, GROUPS, PeakEstimator::AXES);
+    }
+
+    void design(IIR_SOST<T> groups[GROUPS]) const { // notches not placed yet and disabled groups pass through
+        for (std::size_t g = 0; g < GROUPS; ++g) {
+            groups[g].sections = count_;
+            groups[g].order = 2 * count_;
+            for (int i = 0; i < count_; ++i) {
+                IIR_BiquadT<T>& s = groups[g].s[i];
+                if (enabled_[g] && center_[i] > 0) {
+                    s = notch_synth<T>(center_[i], bandwidth_, fs_);
+                } else {
+                    s = IIR_BiquadT<T>{};
+                    s.b[0] = 1;
+                    s.a[0] = 1;
+                }
+            }
+        }
+    }
+
+    ButterworthIIRBank<Lanes, T> bank_ {};
+    PeakEstimator estimator_ {};
+    float center_[MAX_NOTCHES] = {};
+    bool enabled_[GROUPS] = {};
+    int count_ = 0;
+    double fmin_ = 0;
+    double fmax_ = 0;
+    double bandwidth_ = 0;
+    double fs_ = 0;
+};
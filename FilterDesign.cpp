@@ -0,0 +1,254 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+#include "FilterDesign.hpp"
+#include "ButterworthPoly.hpp"
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <utility>
+
+namespace {
+
+using butterworth_detail::Cplx;
+using complex = std::complex<double>;
+
+// Analog prototype in the layout of butter_poles(): poles p[i] and p[N-1-i] are complex conjugates,
+// sorted from the highest to the lowest Q, and p[(N-1)/2] is real when N is odd. Finite zeros come
+// in conjugate pairs, q[i] belonging to the section of p[i] for i < N / 2; the remaining zeros are at
+// infinity. The cutoff is not normalized yet.
+struct Prototype {
+    complex p[BUTTERWORTH_MAX_ORDER];
+    complex q[BUTTERWORTH_MAX_ORDER / 2];
+    int zeros = 0; // number of conjugate zero pairs
+};
+
+// Roots of the monic polynomial c[0] + c[1] s + ... + s^n by Durand-Kerner iteration
+void roots(const double c[], int n, complex r[])
+{
+    for (int i = 0; i < n; ++i) r[i] = std::pow(complex(0.4, 0.9), i);
+    for (int iter = 0; iter < 500; ++iter) {
+        double change = 0;
+        for (int i = 0; i < n; ++i) {
+            complex value = 1, denominator = 1;
+            for (int k = n - 1; k >= 0; --k) value = value * r[i] + c[k];
+            for (int j = 0; j < n; ++j) {
+                if (j != i) denominator *= r[i] - r[j];
+            }
+            const complex step = value / denominator;
+            r[i] -= step;
+            change = std::abs(step) > change ? std::abs(step) : change;
+        }
+        if (change < 1e-14) break;
+    }
+}
+
+// Sorts the upper half-plane poles by Q into the butter_poles() layout
+void arrange(const complex in[], int N, Prototype& proto)
+{
+    complex upper[BUTTERWORTH_MAX_ORDER / 2];
+    int n = 0;
+    for (int i = 0; i < N; ++i) {
+        if (in[i].imag() > 1e-9 * std::abs(in[i])) {
+            upper[n++] = in[i];
+        } else if (N % 2 == 1 && std::fabs(in[i].imag()) <= 1e-9 * std::abs(in[i])) {
+            proto.p[(N - 1) / 2] = complex(in[i].real(), 0);
+        }
+    }
+    assert(n == N / 2);
+    const auto q = [](const complex& p) { return std::abs(p) / (-2 * p.real()); };
+    for (int i = 1; i < n; ++i) { // insertion sort, highest Q first
+        for (int j = i; j > 0 && q(upper[j]) > q(upper[j - 1]); --j) std::swap(upper[j], upper[j - 1]);
+    }
+    for (int i = 0; i < n; ++i) {
+        proto.p[i] = upper[i];
+        proto.p[N - 1 - i] = std::conj(upper[i]);
+    }
+}
+
+// Reverse Bessel polynomial, coefficient of s^k is (2N - k)! / (2^(N - k) k! (N - k)!)
+void bessel(int N, Prototype& proto)
+{
+    double c[BUTTERWORTH_MAX_COEFFS] = {};
+    for (int k = 0; k <= N; ++k) {
+        c[k] = std::exp(std::lgamma(2 * N - k + 1.0) - (N - k) * std::log(2.0) - std::lgamma(k + 1.0) - std::lgamma(N - k + 1.0));
+    }
+    // substitute s = scale u, which puts the roots near the unit circle, and make the polynomial monic
+    const double scale = std::pow(c[0], 1.0 / N);
+    double m[BUTTERWORTH_MAX_COEFFS] = {};
+    for (int k = 0; k <= N; ++k) m[k] = c[k] * std::pow(scale, k) / c[0];
+    for (int k = 0; k < N; ++k) m[k] /= m[N];
+
+    complex r[BUTTERWORTH_MAX_ORDER];
+    roots(m, N, r);
+    for (int i = 0; i < N; ++i) r[i] *= scale;
+    arrange(r, N, proto);
+}
+
+// Chebyshev type I poles for the given passband ripple, passband edge at 1 rad/s
+void chebyshev1(int N, double ripple_db, complex p[])
+{
+    const double eps = std::sqrt(std::pow(10.0, ripple_db / 10) - 1);
+    const double mu = std::asinh(1 / eps) / N;
+    for (int k = 0; k < N; ++k) {
+        const double theta = (2 * k + 1) * M_PI / (2 * N);
+        p[k] = complex(-std::sinh(mu) * std::sin(theta), std::cosh(mu) * std::cos(theta));
+    }
+}
+
+Prototype prototype(FilterFamily family, int N)
+{
+    Prototype proto;
+    complex p[BUTTERWORTH_MAX_ORDER];
+    switch (family) {
+    case FilterFamily::butterworth:
+        for (int k = 0; k < N; ++k) {
+            const double theta = (2 * k + 1) * M_PI / (2 * N);
+            p[k] = complex(-std::sin(theta), std::cos(theta));
+        }
+        arrange(p, N, proto);
+        break;
+    case FilterFamily::bessel:
+        bessel(N, proto);
+        break;
+    case FilterFamily::chebyshev1:
+        chebyshev1(N, CHEBYSHEV1_RIPPLE_DB, p);
+        arrange(p, N, proto);
+        break;
+    case FilterFamily::chebyshev2: {
+        // poles are the inverse of a type I prototype's with the ripple set by the stopband
+        // attenuation, zeros are at 1 / cos(theta_k) on the imaginary axis, stopband edge at 1 rad/s
+        const double ripple_db = 10 * std::log10(1 + 1 / (std::pow(10.0, CHEBYSHEV2_ATTENUATION_DB / 10) - 1));
+        chebyshev1(N, ripple_db, p);
+        for (int k = 0; k < N; ++k) p[k] = 1.0 / std::conj(p[k]);
+        arrange(p, N, proto);
+        // the zero frequencies in ascending order pair with the poles from the highest Q down
+        for (int i = 0; i < N / 2; ++i) proto.q[i] = complex(0, 1 / std::cos((2 * i + 1) * M_PI / (2 * N)));
+        proto.zeros = N / 2;
+        break;
+    }
+    case FilterFamily::critically_damped:
+        for (int k = 0; k < N; ++k) proto.p[k] = -1;
+        break;
+    }
+    return proto;
+}
+
+// |H(jw)|^2 / |H(0)|^2 of the prototype
+double relative_power(const Prototype& proto, int N, double w)
+{
+    const complex s(0, w);
+    double g = 1;
+    for (int i = 0; i < N; ++i) g *= std::norm(proto.p[i]) / std::norm(s - proto.p[i]);
+    for (int i = 0; i < proto.zeros; ++i) g *= std::norm(s - proto.q[i]) * std::norm(s - std::conj(proto.q[i])) / (std::norm(proto.q[i]) * std::norm(proto.q[i]));
+    return g;
+}
+
+// Scales the prototype in frequency so that its gain is -3 dB at 1 rad/s. Above the passband the
+// gain crosses 1 / sqrt(2) only once in every family, so bisection finds that crossing.
+void normalize(Prototype& proto, int N)
+{
+    double lo = 0, hi = 1;
+    while (relative_power(proto, N, hi) > 0.5) hi *= 2;
+    while (hi - lo > 1e-15 * hi) {
+        const double mid = (lo + hi) / 2;
+        (relative_power(proto, N, mid) > 0.5 ? lo : hi) = mid;
+    }
+    const double w3 = (lo + hi) / 2;
+    for (int i = 0; i < N; ++i) proto.p[i] /= w3;
+    for (int i = 0; i < proto.zeros; ++i) proto.q[i] /= w3;
+}
+
+template <typename T>
+Cplx<T> bilinear(const complex& s, T wa, T fs) // Analog root, scaled to wa rad/s, to the z plane
+{
+    const Cplx<T> sa = Cplx<T>(static_cast<T>(s.real()), static_cast<T>(s.imag())) * Cplx<T>(wa);
+    return (Cplx<T>(1) + sa / Cplx<T>(2 * fs)) / (Cplx<T>(1) - sa / Cplx<T>(2 * fs));
+}
+
+// Digital poles p, in the prototype's layout, and zeros q, one per pole with the zeros at infinity
+// mapped to z = -1, for -3 dB at fc
+template <typename T>
+void digital_roots(FilterFamily family, int N, T fc, T fs, Cplx<T> p[], Cplx<T> q[])
+{
+    Prototype proto = prototype(family, N);
+    normalize(proto, N);
+
+    const T pi = static_cast<T>(M_PI);
+    const T wa = 2 * pi * (fs / pi * std::tan(pi * fc / fs)); // prewarped as in butter_poles()
+    for (int i = 0; i < N; ++i) {
+        p[i] = bilinear(proto.p[i], wa, fs);
+        q[i] = Cplx<T>(-1);
+    }
+    for (int i = 0; i < proto.zeros; ++i) {
+        q[i] = bilinear(proto.q[i], wa, fs);
+        q[N - 1 - i] = q[i].conj();
+    }
+}
+
+} // namespace
+
+template <typename T>
+IIR_CoeffsT<T> filter_synth(FilterFamily family, int N, double fc, double fs)
+{
+    if (family == FilterFamily::butterworth) return butter_synth<T>(N, fc, fs);
+    assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER);
+
+    Cplx<T> p[BUTTERWORTH_MAX_ORDER], q[BUTTERWORTH_MAX_ORDER];
+    digital_roots(family, N, static_cast<T>(fc), static_cast<T>(fs), p, q);
+
+    // highest-order-first, as butter_synth(), scaled to unity gain at DC (z = 1)
+    IIR_CoeffsT<T> coeffs;
+    const auto a_poly = butterworth_detail::poly(p, static_cast<size_t>(N));
+    const auto b_poly = butterworth_detail::poly(q, static_cast<size_t>(N));
+    const Cplx<T> K = butterworth_detail::sum(a_poly) / butterworth_detail::sum(b_poly);
+    for (int i = 0; i <= N; ++i) {
+        coeffs.a[i] = a_poly.c[N - i].real();
+        coeffs.b[i] = (b_poly.c[N - i] * K).real();
+    }
+    coeffs.order = N;
+    return coeffs;
+}
+
+template <typename T>
+IIR_SOST<T> filter_synth_sos(FilterFamily family, int N, double fc, double fs)
+{
+    if (family == FilterFamily::butterworth) return butter_synth_sos<T>(N, fc, fs);
+    assert(N >= 1 && N <= BUTTERWORTH_MAX_ORDER);
+
+    Cplx<T> p[BUTTERWORTH_MAX_ORDER], q[BUTTERWORTH_MAX_ORDER];
+    digital_roots(family, N, static_cast<T>(fc), static_cast<T>(fs), p, q);
+
+    // the section order of butter_synth_sos(): real pole first, then pairs from the lowest to the
+    // highest Q, each section with unity gain at DC
+    IIR_SOST<T> sos;
+    int n = 0;
+    if (N % 2 == 1) {
+        IIR_BiquadT<T>& s = sos.s[n++];
+        s.a[0] = 1;
+        s.a[1] = -p[(N - 1) / 2].real();
+        const T g = (1 + s.a[1]) / 2;
+        s.b[0] = g;
+        s.b[1] = g;
+    }
+
+    for (int i = N / 2 - 1; i >= 0; --i) {
+        IIR_BiquadT<T>& s = sos.s[n++];
+        s.a[0] = 1;
+        s.a[1] = -2 * p[i].re;
+        s.a[2] = p[i].re * p[i].re + p[i].im * p[i].im;
+        const T b1 = -2 * q[i].re, b2 = q[i].re * q[i].re + q[i].im * q[i].im;
+        const T g = (1 + s.a[1] + s.a[2]) / (1 + b1 + b2);
+        s.b[0] = g;
+        s.b[1] = g * b1;
+        s.b[2] = g * b2;
+    }
+
+    sos.sections = n;
+    sos.order = N;
+    return sos;
+}
+
+template IIR_CoeffsT<float> filter_synth<float>(FilterFamily family, int N, double fc, double fs);
+template IIR_CoeffsT<double> filter_synth<double>(FilterFamily family, int N, double fc, double fs);
+template IIR_SOST<float> filter_synth_sos<float>(FilterFamily family, int N, double fc, double fs);
+template IIR_SOST<double> filter_synth_sos<double>(FilterFamily family, int N, double fc, double fs);
@@ -0,0 +1,61 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Low-pass filter families beyond Butterworth, designed through the same bilinear transform and
+// returned in the same IIR_Coeffs and IIR_SOS structs, so every filter realization runs them.
+// Each family's analog prototype is normalized so that fc is the -3 dB frequency, relative to the
+// gain at DC, as for butter_synth(). A cutoff therefore means the same bandwidth in every family,
+// and only the shape of the transition, the ripple and the group delay differ:
+//     butterworth        maximally flat magnitude
+//     bessel             maximally flat group delay, the least delay for a given cutoff and the
+//                        slowest roll-off, no overshoot to speak of
+//     chebyshev1         CHEBYSHEV1_RIPPLE_DB of passband ripple for a steeper transition, more
+//                        delay and ringing
+//     chebyshev2         flat passband and zeros in the stopband, which stays CHEBYSHEV2_ATTENUATION_DB
+//                        down; the zeros are not at z = -1, so butter_derivative() does not apply
+//     critically_damped  N coincident real poles, no overshoot at all, but a soft knee
+// All filters have unity gain at DC, every section of the cascade too.
+
+#pragma once
+#include "ButterworthSynth.hpp"
+
+enum class FilterFamily : int {
+    butterworth = 0,
+    bessel = 1,
+    chebyshev1 = 2,
+    chebyshev2 = 3,
+    critically_damped = 4,
+};
+
+constexpr int FILTER_FAMILIES = 5;
+constexpr double CHEBYSHEV1_RIPPLE_DB = 0.5; // Peak to peak passband ripple
+constexpr double CHEBYSHEV2_ATTENUATION_DB = 40.0; // Minimum stopband attenuation
+
+// Family from its number, e.g. a parameter value, or butterworth if out of range
+inline FilterFamily filter_family(int value)
+{
+    return value >= 0 && value < FILTER_FAMILIES ? static_cast<FilterFamily>(value) : FilterFamily::butterworth;
+}
+
+inline const char* filter_family_name(FilterFamily family)
+{
+    switch (family) {
+    case FilterFamily::bessel: return "bessel";
+    case FilterFamily::chebyshev1: return "chebyshev1";
+    case FilterFamily::chebyshev2: return "chebyshev2";
+    case FilterFamily::critically_damped: return "critically_damped";
+    case FilterFamily::butterworth: break;
+    }
+    return "butterworth";
+}
+
+// True if all zeros of the family are at z = -1, as butter_derivative() requires
+constexpr bool filter_all_pole(FilterFamily family) { return family != FilterFamily::chebyshev2; }
+
+// Order N, -3 dB freq fc, sampling freq fs. Butterworth is exactly butter_synth(). The analog
+// prototype is found in double, the bilinear transform and expansion run in T.
+// Instantiated for float and double in FilterDesign.cpp.
+template <typename T = double>
+IIR_CoeffsT<T> filter_synth(FilterFamily family, int N, double fc, double fs);
+
+template <typename T = double>
+IIR_SOST<T> filter_synth_sos(FilterFamily family, int N, double fc, double fs); // Same filter as filter_synth, split into sections
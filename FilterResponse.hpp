@@ -0,0 +1,170 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Frequency response of synthesized filters and of chains of them: magnitude, phase and group
+// delay on a frequency grid, and the poles with their distance to the unit circle. A chain is a
+// cascade of stages, each a ratio of polynomials in z^-1, e.g. the angular acceleration path
+// gyro filter -> backward difference -> angular acceleration filter. Everything is evaluated in
+// double, from the coefficients as stored in T, so a float filter shows its rounded response.
+
+#pragma once
+#include "ButterworthSynth.hpp"
+#include <cmath>
+#include <complex>
+#include <cstddef>
+
+struct FrequencyResponse {
+    double f = 0; // frequency in Hz
+    double magnitude = 0;
+    double phase_rad = 0; // unwrapped along the grid by ResponseChain::evaluate()
+    double group_delay_s = 0;
+};
+
+class ResponseChain {
+public:
+    static constexpr int MAX_STAGES = 2 * BUTTERWORTH_MAX_SECTIONS + 2;
+    static constexpr int MAX_POLES = MAX_STAGES * BUTTERWORTH_MAX_ORDER;
+
+    explicit ResponseChain(double fs) : fs_(fs) {}
+
+    double fs() const { return fs_; }
+
+    template <typename T>
+    ResponseChain& add(const IIR_CoeffsT<T>& c) { // Whole polynomial, poles found numerically
+        Stage& s = push(c.order);
+        for (int k = 0; k <= c.order; ++k) {
+            s.b[k] = static_cast<double>(c.b[k]);
+            s.a[k] = static_cast<double>(c.a[k]);
+        }
+        return *this;
+    }
+
+    template <typename T>
+    ResponseChain& add(const IIR_SOST<T>& c) { // One stage per section
+        for (int i = 0; i < c.sections; ++i) {
+            const bool first_order = c.s[i].a[2] == 0 && c.s[i].b[2] == 0;
+            Stage& s = push(first_order ? 1 : 2);
+            for (int k = 0; k <= s.order; ++k) {
+                s.b[k] = static_cast<double>(c.s[i].b[k]);
+                s.a[k] = static_cast<double>(c.s[i].a[k]);
+            }
+        }
+        return *this;
+    }
+
+    ResponseChain& addDifference() { // Backward difference divided by the sample interval
+        Stage& s = push(1);
+        s.b[0] = fs_;
+        s.b[1] = -fs_;
+        s.a[0] = 1;
+        s.a[1] = 0;
+        return *this;
+    }
+
+    std::complex<double> freqz(double f) const { // Complex response at f
+        const double w = 2 * M_PI * f / fs_;
+        std::complex<double> h = 1;
+        for (int i = 0; i < stages_; ++i) h *= poly(stage_[i].b, stage_[i].order, w) / poly(stage_[i].a, stage_[i].order, w);
+        return h;
+    }
+
+    double groupDelay(double f) const { // Group delay in seconds
+        // d(arg H)/dw of a polynomial sum c_k e^-jwk is -Re(sum k c_k e^-jwk / sum c_k e^-jwk)
+        const double w = 2 * M_PI * f / fs_;
+        double samples = 0;
+        for (int i = 0; i < stages_; ++i) {
+            samples += delay(stage_[i].b, stage_[i].order, w) - delay(stage_[i].a, stage_[i].order, w);
+        }
+        return samples / fs_;
+    }
+
+    // Response at n frequencies, with the phase unwrapped from one grid point to the next
+    void evaluate(const double f[], std::size_t n, FrequencyResponse out[]) const {
+        double last = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::complex<double> h = freqz(f[i]);
+            double phase = std::arg(h);
+            if (i > 0) phase += 2 * M_PI * std::round((last - phase) / (2 * M_PI));
+            last = phase;
+            out[i].f = f[i];
+            out[i].magnitude = std::abs(h);
+            out[i].phase_rad = phase;
+            out[i].group_delay_s = groupDelay(f[i]);
+        }
+    }
+
+    // Writes the poles of every stage to p and returns their number
+    int poles(std::complex<double> p[MAX_POLES]) const {
+        int n = 0;
+        for (int i = 0; i < stages_; ++i) n += roots(stage_[i].a, stage_[i].order, &p[n]);
+        return n;
+    }
+
+    double maxPoleRadius() const { // Stable below 1, the margin to instability is 1 minus this
+        std::complex<double> p[MAX_POLES];
+        const int n = poles(p);
+        double r = 0;
+        for (int i = 0; i < n; ++i) r = std::abs(p[i]) > r ? std::abs(p[i]) : r;
+        return r;
+    }
+
+private:
+    struct Stage {
+        double b[BUTTERWORTH_MAX_COEFFS] = {}; // b[k] and a[k] are the coefficients of z^-k
+        double a[BUTTERWORTH_MAX_COEFFS] = {};
+        int order = 0;
+    };
+
+    Stage& push(int order) {
+        assert(stages_ < MAX_STAGES && order >= 0 && order <= BUTTERWORTH_MAX_ORDER);
+        Stage& s = stage_[stages_++];
+        s = Stage{};
+        s.order = order;
+        return s;
+    }
+
+    static std::complex<double> poly(const double c[], int order, double w) { // sum c_k e^-jwk
+        std::complex<double> sum = 0;
+        for (int k = 0; k <= order; ++k) sum += c[k] * std::polar(1.0, -w * k);
+        return sum;
+    }
+
+    static double delay(const double c[], int order, double w) { // group delay of the polynomial in samples
+        std::complex<double> sum = 0, weighted = 0;
+        for (int k = 0; k <= order; ++k) {
+            const std::complex<double> term = c[k] * std::polar(1.0, -w * k);
+            sum += term;
+            weighted += static_cast<double>(k) * term;
+        }
+        return std::abs(sum) > 0 ? std::real(weighted / sum) : 0; // undefined on a zero, e.g. at Nyquist
+    }
+
+    // Roots in z of a[0] z^order + a[1] z^(order-1) + ... + a[order], by Durand-Kerner iteration
+    static int roots(const double a[], int order, std::complex<double> r[]) {
+        assert(a[0] != 0);
+        int n = order;
+        while (n > 0 && a[n] == 0) --n; // every zero trailing coefficient is a pole at the origin
+        for (int i = n; i < order; ++i) r[i] = 0;
+        if (n == 0) return order;
+
+        for (int i = 0; i < n; ++i) r[i] = std::polar(0.9, 2 * M_PI * (i + 0.25) / n); // spread over a circle
+        for (int iter = 0; iter < 500; ++iter) {
+            double change = 0;
+            for (int i = 0; i < n; ++i) {
+                std::complex<double> value = a[0], denominator = a[0];
+                for (int k = 1; k <= n; ++k) value = value * r[i] + a[k];
+                for (int j = 0; j < n; ++j) {
+                    if (j != i) denominator *= r[i] - r[j];
+                }
+                const std::complex<double> step = value / denominator;
+                r[i] -= step;
+                change = std::abs(step) > change ? std::abs(step) : change;
+            }
+            if (change < 1e-15) break;
+        }
+        return order;
+    }
+
+    Stage stage_[MAX_STAGES] {};
+    int stages_ = 0;
+    double fs_;
+};
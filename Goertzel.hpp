@@ -0,0 +1,79 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// A bank of Goertzel recursions: the DFT of Hann-windowed frames of Window samples, restricted to a
+// run of consecutive bins and advanced by one sample at a time. Every sample costs one multiply-add
+// per bin and axis, and the power of a bin is read from its two state values when the frame is
+// complete, so there is no FFT burst and no frame buffer. Frames do not overlap. Runs in float,
+// whatever the type of the samples.
+
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+template <int Axes, int Window, int MaxBins = Window / 2>
+class GoertzelBank {
+public:
+    static_assert(MaxBins <= Window / 2, "bins above the Nyquist frequency");
+
+    GoertzelBank() {
+        for (int n = 0; n < Window; ++n) window_[n] = static_cast<float>(0.5 - 0.5 * std::cos(2 * M_PI * n / Window));
+    }
+
+    // bins DFT bins from first on, bin k being at k fs / Window; restarts the frame
+    void configure(int first, int bins) {
+        first_ = first;
+        bins_ = bins < 0 ? 0 : (bins > MaxBins ? MaxBins : bins);
+        for (int k = 0; k < bins_; ++k) coeff_[k] = static_cast<float>(2 * std::cos(2 * M_PI * (first_ + k) / Window));
+        restart();
+    }
+
+    void restart() {
+        n_ = 0;
+        for (int a = 0; a < Axes; ++a) {
+            for (int k = 0; k < MaxBins; ++k) {
+                s1_[a][k] = 0;
+                s2_[a][k] = 0;
+            }
+        }
+    }
+
+    int first() const { return first_; }
+    int bins() const { return bins_; }
+    int remaining() const { return n_ == Window ? Window : Window - n_; } // Samples until the frame completes
+
+    // Adds n rows of which the first Axes values are used, stride values apart. n must not exceed
+    // remaining(). Returns true if the last row completed a frame, whose power() then stays valid
+    // until the next push starts a new one.
+    template <typename T>
+    bool push(const T* rows, std::size_t n, std::size_t stride) {
+        if (n_ == Window) restart();
+        for (std::size_t t = 0; t < n; ++t) {
+            const float w = window_[n_++];
+            for (int a = 0; a < Axes; ++a) {
+                const float x = w * static_cast<float>(rows[t * stride + a]);
+                float* s1 = s1_[a];
+                float* s2 = s2_[a];
+                for (int k = 0; k < bins_; ++k) {
+                    const float s = x + coeff_[k] * s1[k] - s2[k];
+                    s2[k] = s1[k];
+                    s1[k] = s;
+                }
+            }
+        }
+        return n_ == Window;
+    }
+
+    float power(int axis, int bin) const { // |X|^2 of bin first() + bin in the last complete frame
+        const float s1 = s1_[axis][bin], s2 = s2_[axis][bin];
+        return s1 * s1 + s2 * s2 - coeff_[bin] * s1 * s2;
+    }
+
+private:
+    float window_[Window];
+    float coeff_[MaxBins] = {}; // 2 cos(2 pi k / Window) of each bin
+    float s1_[Axes][MaxBins] = {}; // Goertzel state of each axis and bin
+    float s2_[Axes][MaxBins] = {};
+    int first_ = 1;
+    int bins_ = 0;
+    int n_ = 0; // samples in the current frame
+};
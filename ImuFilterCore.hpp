@@ -0,0 +1,307 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Per-sample filtering of one IMU, or several, without any PX4 dependency, so that the same code
+// runs in the imu_filtering module and in host tools. A row holds the three gyro axes followed by
+// the three accelerometer axes. Both sensors share one filter bank for their values and one for
+// their derivatives: angular rate and acceleration are low-pass filtered, differentiated over the
+// sample interval, and the derivatives (angular acceleration and jerk) are low-pass filtered again.
+// Optionally, rows are decimated by 2, 4 or 8 ahead of the filters (see Decimator.hpp).
+//
+// With angacc_fused or jerk_fused, the derivative of that sensor is instead the bilinear derivative
+// of its low-pass filter (see butter_derivative()), taken from the same filter state in the same
+// pass: no second filter, no difference, and none of their delay. Its order and cutoff are then
+// those of the value filter, and it assumes the nominal sample rate instead of the measured dt.
+//
+// Each filter can be of any family in FilterDesign.hpp, e.g. Bessel for less delay in the
+// derivatives. A fused derivative needs a family with all zeros at z = -1, not chebyshev2.
+//
+// With notch_count above zero, tracking notches on the vibration peaks of the angular rate run on
+// the gyro and/or accelerometer lanes ahead of the low-pass filters (see DynamicNotch.hpp).
+//
+// With spectrum_rate_hz above zero, the spectra of the rows before and after all filters, and their
+// noise power above each low-pass cutoff, are reported about that often (see SpectrumMonitor.hpp).
+//
+// Every filter starts at the steady state of the first row, as if that row had been constant
+// forever, instead of ramping up from zero: the values are valid from the first row on and the
+// derivatives start at zero. The same warm start follows a gap in step(), and restart() requests
+// it for one IMU, e.g. when it comes back after a dropout or replaces a failed one.
+//
+// With Imus above one, a row holds the six lanes of each IMU in turn and all of them run through the
+// same banks in one pass, with the same configuration. The notches follow the peaks of the first
+// IMU, and the spectrum monitors the first IMU only. Decimation is left out by default, which saves
+// the decimator's history of every lane, as several IMUs are stepped one row at a time.
+
+#pragma once
+#include "ButterworthBank.hpp"
+#include "CoeffCache.hpp"
+#include "Decimator.hpp"
+#include "DynamicNotch.hpp"
+#include "FilterDesign.hpp"
+#include "SpectrumMonitor.hpp"
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+struct ImuFilterConfig { // Families, orders and cutoff frequencies in Hz of the four filters
+    FilterFamily gyro_family = FilterFamily::butterworth;
+    int gyro_order = 2;
+    double gyro_cutoff_hz = 30.0;
+    FilterFamily angacc_family = FilterFamily::butterworth;
+    int angacc_order = 2;
+    double angacc_cutoff_hz = 30.0;
+    FilterFamily accel_family = FilterFamily::butterworth;
+    int accel_order = 2;
+    double accel_cutoff_hz = 30.0;
+    FilterFamily jerk_family = FilterFamily::butterworth;
+    int jerk_order = 2;
+    double jerk_cutoff_hz = 30.0;
+    bool angacc_fused = false; // angular acceleration from the gyro filter, angacc filter unused
+    bool jerk_fused = false; // jerk from the accelerometer filter, jerk filter unused
+    int notch_count = 0; // dynamic notches per lane, 0 disables them
+    bool notch_gyro = true; // notches on the angular rate lanes
+    bool notch_accel = false; // notches on the acceleration lanes
+    double notch_min_hz = 80.0; // peak search band
+    double notch_max_hz = 200.0;
+    double notch_bandwidth_hz = 20.0; // -3 dB width of each notch
+    double spectrum_rate_hz = 0.0; // spectrum reports per second, 0 disables the monitor
+
+    bool operator==(const ImuFilterConfig& o) const {
+        return gyro_family == o.gyro_family && gyro_order == o.gyro_order && gyro_cutoff_hz == o.gyro_cutoff_hz
+               && angacc_family == o.angacc_family && angacc_order == o.angacc_order && angacc_cutoff_hz == o.angacc_cutoff_hz
+               && accel_family == o.accel_family && accel_order == o.accel_order && accel_cutoff_hz == o.accel_cutoff_hz
+               && jerk_family == o.jerk_family && jerk_order == o.jerk_order && jerk_cutoff_hz == o.jerk_cutoff_hz
+               && angacc_fused == o.angacc_fused && jerk_fused == o.jerk_fused
+               && notch_count == o.notch_count && notch_gyro == o.notch_gyro && notch_accel == o.notch_accel
+               && notch_min_hz == o.notch_min_hz && notch_max_hz == o.notch_max_hz
+               && notch_bandwidth_hz == o.notch_bandwidth_hz && spectrum_rate_hz == o.spectrum_rate_hz;
+    }
+    bool operator!=(const ImuFilterConfig& o) const { return !(*this == o); }
+};
+
+template <typename T = double, std::size_t Imus = 1, bool Decimation = Imus == 1>
+class ImuFilterCore {
+public:
+    static constexpr int GYRO = 0; // first lane of each sensor in the lanes of an IMU
+    static constexpr int ACCEL = 3;
+    static constexpr int AXES = 3;
+    static constexpr int IMU_LANES = 6;
+    static constexpr int IMUS = static_cast<int>(Imus);
+    static constexpr int LANES = IMU_LANES * IMUS;
+
+    using Cache = CoeffCache<T, 16>;
+    using Spectrum = SpectrumMonitor<IMU_LANES>; // of the first IMU
+
+    // Synthesize the filters for config at sample_rate_hz, the rate of the rows after decimation.
+    // Running filters are warm-started at their last output, so that retuning while running
+    // produces no step or transient. Returns false, and keeps the previous filters, if any design
+    // is invalid, e.g. a cutoff above the Nyquist frequency, a fused derivative of a chebyshev2 filter
+    // or an empty notch search band.
+    bool configure(const ImuFilterConfig& config, double sample_rate_hz) {
+        // sets used before, e.g. when switching back while tuning, come from the cache without synthesis
+        const IIR_SOST<T> coeffs[2] {
+            cache_.get(config.gyro_family, config.gyro_order, config.gyro_cutoff_hz, sample_rate_hz),
+            cache_.get(config.accel_family, config.accel_order, config.accel_cutoff_hz, sample_rate_hz)
+        };
+        // a fused derivative bypasses the derivative filter of its group, which keeps a copy of the
+        // value filter to stay valid whatever the unused order and cutoff are set to
+        const IIR_SOST<T> derivative_coeffs[2] {
+            config.angacc_fused ? coeffs[0] : cache_.get(config.angacc_family, config.angacc_order, config.angacc_cutoff_hz, sample_rate_hz),
+            config.jerk_fused ? coeffs[1] : cache_.get(config.jerk_family, config.jerk_order, config.jerk_cutoff_hz, sample_rate_hz)
+        };
+
+        if ((config.angacc_fused && !filter_all_pole(config.gyro_family))
+            || (config.jerk_fused && !filter_all_pole(config.accel_family))) {
+            return false;
+        }
+
+        if (config.notch_count > 0 && !(config.notch_min_hz > 0 && config.notch_min_hz < config.notch_max_hz
+                                        && config.notch_min_hz < 0.45 * sample_rate_hz && config.notch_bandwidth_hz > 0)) {
+            return false;
+        }
+
+        for (int g = 0; g < 2; ++g) {
+            if (!sos_stable(coeffs[g]) || !sos_stable(derivative_coeffs[g])) return false;
+        }
+
+        T out[LANES], derivative_out[LANES];
+        for (int l = 0; l < LANES; ++l) {
+            out[l] = filter_.output()[l];
+            derivative_out[l] = derivative_filter_.output()[l];
+        }
+
+        // lanes 0-2 of each IMU take the gyro coefficients, lanes 3-5 the accelerometer ones
+        if (config.angacc_fused || config.jerk_fused) {
+            const IIR_SOST<T> derivatives[2] {butter_derivative(coeffs[0], sample_rate_hz), butter_derivative(coeffs[1], sample_rate_hz)};
+            filter_.setCoeffs(coeffs, derivatives, 2, AXES);
+        } else {
+            filter_.setCoeffs(coeffs, 2, AXES);
+        }
+        filter_.reset(out);
+        derivative_filter_.setCoeffs(derivative_coeffs, 2, AXES);
+        derivative_filter_.reset(derivative_out);
+
+        const bool notch_groups[2] {config.notch_gyro, config.notch_accel};
+        notch_.configure(config.notch_count, notch_groups, config.notch_min_hz, config.notch_max_hz,
+                         config.notch_bandwidth_hz, sample_rate_hz);
+
+        int frames = 0; // whole frames per spectrum report, at least one
+        if (config.spectrum_rate_hz > 0) {
+            const double f = sample_rate_hz / Spectrum::WINDOW / config.spectrum_rate_hz;
+            frames = f > 1 ? static_cast<int>(f + 0.5) : 1;
+        }
+        const double noise_hz[Spectrum::GROUPS] {config.gyro_cutoff_hz, config.accel_cutoff_hz};
+        spectrum_.configure(sample_rate_hz, frames, noise_hz);
+
+        config_ = config;
+        sample_rate_hz_ = sample_rate_hz;
+        fused_[0] = config.angacc_fused;
+        fused_[1] = config.jerk_fused;
+        return true;
+    }
+
+    // 1, 2, 4 or 8, other values disable decimation, as does a core without Decimation. Clears the
+    // decimator, which warm-starts at the next row of processBuffer().
+    void setDecimation(int ratio) {
+        decimator_.setRatio((ratio == 2 || ratio == 4 || ratio == 8) ? ratio : 1);
+        decimator_started_ = false;
+        restartDerivative();
+    }
+
+    // The next row starts the derivative again instead of differentiating across a gap
+    void restartDerivative() { prev_valid_ = false; }
+
+    // The next row warm-starts the filters of IMU imu, or of every IMU if imu is negative, at its
+    // steady state instead of continuing from their state. The decimator restarts only with every IMU.
+    void restart(int imu = -1) {
+        for (int k = 0; k < IMUS; ++k) started_[k] = started_[k] && imu >= 0 && imu != k;
+        decimator_started_ = decimator_started_ && imu >= 0;
+    }
+
+    // Filter one row taken dt_s after the previous one, bypassing the decimator. A dt_s of zero or
+    // less (first sample, gap) warm-starts every filter at this row, and the derivative is zero.
+    void step(const T in[LANES], T dt_s, T out[LANES], T derivative[LANES]) {
+        if (!(dt_s > 0)) restart();
+        warmStart(in);
+
+        filterRows(in, out, fused_rows_, 1);
+
+        if (!prev_valid_ || !(dt_s > 0)) {
+            for (int l = 0; l < LANES; ++l) {
+                prev_[l] = out[l];
+                derivative[l] = 0;
+            }
+            prev_valid_ = true;
+        } else {
+            differentiate(out, derivative, 1, dt_s);
+        }
+
+        useFused(fused_rows_, derivative, 1);
+    }
+
+    // Decimate and filter n consecutive rows taken input_dt_s apart, in place in x. The filtered
+    // rows, n / decimation() depending on the decimator phase, are left at the start of x, their
+    // derivatives in dx, and their number is returned. dx must hold n rows.
+    std::size_t processBuffer(T* x, T* dx, std::size_t n, T input_dt_s) {
+        if (!decimator_started_ && n > 0) {
+            decimator_.reset(x);
+            decimator_started_ = true;
+        }
+        n = decimator_.processBuffer(x, x, n);
+        const T dt_s = input_dt_s * decimator_.ratio();
+
+        for (std::size_t start = 0; start < n; start += kChunk) {
+            const std::size_t m = n - start < kChunk ? n - start : kChunk;
+            T* rows = x + start * LANES;
+            T* derivative = dx + start * LANES;
+            warmStart(rows);
+            filterRows(rows, rows, fused_rows_, m);
+
+            if (!prev_valid_) { // the first row has no predecessor to differentiate against
+                for (int l = 0; l < LANES; ++l) prev_[l] = rows[l];
+                prev_valid_ = true;
+            }
+            differentiate(rows, derivative, m, dt_s);
+            useFused(fused_rows_, derivative, m);
+        }
+        return n;
+    }
+
+    int decimation() const { return decimator_.ratio(); }
+    int pending() const { return decimator_.pending(); } // Input rows held back by the decimator
+    double sampleRate() const { return sample_rate_hz_; } // Rate the filters run at, 0 until configured
+    const ImuFilterConfig& config() const { return config_; }
+    const Cache& cache() const { return cache_; }
+    const DynamicNotch<LANES, T>& notch() const { return notch_; }
+    const Spectrum& spectrum() const { return spectrum_; }
+
+private:
+    // rows per pass in processBuffer, one full IMU FIFO, and as many values with several IMUs
+    static constexpr std::size_t kChunk = LANES <= IMU_LANES ? 32 : (32 * IMU_LANES) / LANES;
+
+    void filterRows(const T* in, T* out, T* fused, std::size_t n) { // fused is written only if a group is fused
+        spectrum_.pushInput(in, n, LANES);
+        if (notch_.active()) { // in place on out, ahead of the low-pass filters
+            if (out != in) std::memcpy(out, in, n * LANES * sizeof(T));
+            notch_.processBuffer(out, n);
+            in = out;
+        }
+        if (filter_.hasDerivative()) {
+            filter_.processBuffer(in, out, fused, n);
+        } else {
+            filter_.processBuffer(in, out, n);
+        }
+        spectrum_.pushOutput(out, n, LANES);
+    }
+
+    // Set the filters of the IMUs marked by restart() to the steady state of row, so that filtering
+    // it returns the row itself and a zero derivative
+    void warmStart(const T row[LANES]) {
+        const T zero[LANES] = {};
+        for (int k = 0; k < IMUS; ++k) {
+            if (started_[k]) continue;
+            const std::size_t first = static_cast<std::size_t>(k) * IMU_LANES;
+            notch_.reset(row, first, IMU_LANES);
+            filter_.reset(notch_.active() ? notch_.output() : row, first, IMU_LANES);
+            derivative_filter_.reset(zero, first, IMU_LANES);
+            for (std::size_t l = first; l < first + IMU_LANES; ++l) prev_[l] = filter_.output()[l];
+            started_[k] = true;
+        }
+    }
+
+    // Backward difference of n filtered rows against their predecessors, low-pass filtered. Skipped
+    // when both groups are fused and would overwrite it anyway.
+    void differentiate(const T* x, T* dx, std::size_t n, T dt_s) {
+        for (std::size_t t = 0; t < n; ++t) {
+            for (int l = 0; l < LANES; ++l) {
+                const T v = x[t * LANES + l];
+                dx[t * LANES + l] = (v - prev_[l]) / dt_s;
+                prev_[l] = v;
+            }
+        }
+        if (!(fused_[0] && fused_[1])) derivative_filter_.processBuffer(dx, dx, n);
+    }
+
+    void useFused(const T* fused, T* dx, std::size_t n) const { // overwrite the derivatives of fused groups
+        for (int g = 0; g < LANES / AXES; ++g) {
+            if (!fused_[g % 2]) continue;
+            for (std::size_t t = 0; t < n; ++t) {
+                for (int l = g * AXES; l < (g + 1) * AXES; ++l) dx[t * LANES + l] = fused[t * LANES + l];
+            }
+        }
+    }
+
+    ButterworthIIRBank<LANES, T> filter_ {}, // angular rate and acceleration
+                                 derivative_filter_ {}; // angular acceleration and jerk
+    Cache cache_ {}; // sections of all four filters, keyed by order, cutoff and rate
+    typename std::conditional<Decimation, PolyphaseDecimator<LANES, T>, NoDecimator<LANES, T>>::type decimator_ {};
+    DynamicNotch<LANES, T> notch_ {};
+    Spectrum spectrum_ {};
+    ImuFilterConfig config_ {};
+    double sample_rate_hz_ = 0;
+    T prev_[LANES] = {}; // last filtered row, for the derivatives
+    bool prev_valid_ = false;
+    bool started_[IMUS] = {}; // IMUs whose filters continue from their state, the others warm-start
+    bool decimator_started_ = false;
+    bool fused_[2] = {}; // gyro and accelerometer derivatives taken from filter_
+    T fused_rows_[kChunk * LANES] = {}; // fused derivatives of one pass, kept off the work queue stack
+};
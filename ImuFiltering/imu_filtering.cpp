@@ -0,0 +1,846 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+#include "imu_filtering.hpp"
+#include <cstring>
+
+
+void ImuFiltering::Publish()
+{
+	perf_begin(_publish_perf);
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	std::memcpy(_gyro_filtered_data.angrate_radps, _angrate_radps, sizeof(_angrate_radps));
+	std::memcpy(_gyro_filtered_data.angacc_radps2, _angacc_radps2, sizeof(_angacc_radps2));
+	_gyro_filtered_data.timestamp_sample = _timestamp_sample;
+	_gyro_filtered_data.device_id = _fifo_mode ? _gyro_calibration.device_id() : 0;
+	_gyro_filtered_data.timestamp = now;
+	_gyro_filtered_data_pub.publish(_gyro_filtered_data);
+
+	std::memcpy(_accel_filtered_data.accel_mps2, _accel_mps2, sizeof(_accel_mps2));
+	std::memcpy(_accel_filtered_data.jerk_mps3, _jerk_mps3, sizeof(_jerk_mps3));
+	_accel_filtered_data.timestamp_sample = _timestamp_sample;
+	_accel_filtered_data.device_id = _fifo_mode ? _accel_calibration.device_id() : 0;
+	_accel_filtered_data.timestamp = now;
+	_accel_filtered_data_pub.publish(_accel_filtered_data);
+
+	if (_timestamp_sample != 0 && now >= _timestamp_sample) {
+		_latency.record(now - _timestamp_sample);
+	}
+
+	if (_core.spectrum().reports() != _spectrum_reports) {
+		PublishSpectrum(_core);
+	}
+
+	perf_end(_publish_perf);
+}
+
+void ImuFiltering::PublishMulti()
+{
+	perf_begin(_publish_perf);
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+		// instances that never published or stopped publishing, e.g. a failed IMU, are left out
+		const hrt_abstime gyro_timestamp_sample = _multi_gyro_timestamp_sample[k];
+
+		if (gyro_timestamp_sample == 0 || gyro_timestamp_sample + MULTI_TIMEOUT_US < _timestamp_sample) {
+			continue;
+		}
+
+		_multi_gyro_filtered_data[k].timestamp = now;
+		_gyro_filtered_data_multi_pub[k].publish(_multi_gyro_filtered_data[k]);
+
+		const hrt_abstime accel_timestamp_sample = _multi_accel_timestamp_sample[k];
+
+		if (accel_timestamp_sample != 0 && accel_timestamp_sample + MULTI_TIMEOUT_US >= _timestamp_sample) {
+			_multi_accel_filtered_data[k].timestamp = now;
+			_accel_filtered_data_multi_pub[k].publish(_multi_accel_filtered_data[k]);
+		}
+	}
+
+	if (_timestamp_sample != 0 && now >= _timestamp_sample) {
+		_latency.record(now - _timestamp_sample);
+	}
+
+	if (_multi_core->spectrum().reports() != _spectrum_reports) {
+		PublishSpectrum(*_multi_core);
+	}
+
+	perf_end(_publish_perf);
+}
+
+// Spectrum of the first IMU, the only one the core monitors
+template<typename Core>
+void ImuFiltering::PublishSpectrum(const Core &core)
+{
+	const typename Core::Spectrum::Report &report = core.spectrum().report();
+	_spectrum_reports = core.spectrum().reports();
+
+	imu_filter_spectrum_s spectrum{};
+	spectrum.timestamp_sample = _timestamp_sample;
+	spectrum.bin_hz = report.bin_hz;
+	spectrum.frames = static_cast<uint16_t>(report.frames);
+	std::memcpy(spectrum.gyro_in_psd, report.in[0], sizeof(spectrum.gyro_in_psd));
+	std::memcpy(spectrum.gyro_out_psd, report.out[0], sizeof(spectrum.gyro_out_psd));
+	std::memcpy(spectrum.accel_in_psd, report.in[1], sizeof(spectrum.accel_in_psd));
+	std::memcpy(spectrum.accel_out_psd, report.out[1], sizeof(spectrum.accel_out_psd));
+	spectrum.gyro_noise_in = report.noise_in[0];
+	spectrum.gyro_noise_out = report.noise_out[0];
+	spectrum.accel_noise_in = report.noise_in[1];
+	spectrum.accel_noise_out = report.noise_out[1];
+	spectrum.timestamp = hrt_absolute_time();
+	_imu_filter_spectrum_pub.publish(spectrum);
+}
+
+constexpr uint32_t LatencyHistogram::EDGES_US[];
+
+void LatencyHistogram::print() const
+{
+	PX4_INFO("sample to publish latency: %u samples, mean %.0f us, max %llu us", (unsigned)_total,
+		 _total > 0 ? (double)_sum_us / _total : 0.0, (unsigned long long)_max_us);
+
+	for (int bin = 0; bin < BINS; bin++) {
+		if (bin < BINS - 1) {
+			PX4_INFO("  < %5u us: %u", (unsigned)EDGES_US[bin], (unsigned)_count[bin]);
+
+		} else {
+			PX4_INFO("  >=%5u us: %u", (unsigned)EDGES_US[bin - 1], (unsigned)_count[bin]);
+		}
+	}
+}
+
+int ImuFiltering::task_spawn(int argc, char *argv[])
+{
+	ImuFiltering *instance = new ImuFiltering();
+
+	if (instance) {
+		_object.store(instance);
+		_task_id = task_id_is_work_queue;
+
+		if (instance->init()) {
+			return PX4_OK;
+		}
+
+	} else {
+		PX4_ERR("alloc failed");
+	}
+
+	delete instance;
+	_object.store(nullptr);
+	_task_id = -1;
+
+	return PX4_ERROR;
+}
+int ImuFiltering::print_status()
+{
+	static constexpr const char *WQ_NAMES[] {"lp_default", "rate_ctrl", "INS0"};
+	const int wq = math::constrain(static_cast<int>(_param_sfilt_wq.get()), 0, 2);
+
+	if (_multi_mode) {
+		PX4_INFO("input: sensor_gyro, sensor_accel, all instances on %s, clock on gyro %d", WQ_NAMES[wq], _multi_clock);
+		PX4_INFO("input rate: %.1f Hz (measured), filter rate: %.1f Hz", 1.0 / (double)_step_size, SampleRate());
+
+		for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+			if (_multi_gyro_timestamp_sample[k] != 0) {
+				PX4_INFO("IMU %d: gyro %u, accel %u%s", k, (unsigned)_gyro_calibrations[k].device_id(),
+					 (unsigned)_accel_calibrations[k].device_id(),
+					 _multi_gyro_timestamp_sample[k] + MULTI_TIMEOUT_US < _timestamp_sample ? ", timed out" : "");
+			}
+		}
+
+	} else if (_fifo_mode) {
+		PX4_INFO("input: sensor_gyro_fifo, sensor_accel_fifo on %s", WQ_NAMES[wq]);
+		PX4_INFO("input rate: %.1f Hz, filter rate: %.1f Hz, decimation %d:1, publishing every %d samples",
+			 _fifo_dt_us > 0.f ? 1e6 / (double)_fifo_dt_us : 0.0, _core.sampleRate(), _core.decimation(), _decimation);
+
+	} else {
+		PX4_INFO("input: vehicle_angular_velocity, vehicle_acceleration on %s", WQ_NAMES[wq]);
+		PX4_INFO("input rate: %.1f Hz (measured), filter rate: %.1f Hz", 1.0 / (double)_step_size, _core.sampleRate());
+	}
+
+	if (_multi_core != nullptr) {
+		PrintFilterStatus(*_multi_core);
+
+	} else {
+		PrintFilterStatus(_core);
+	}
+
+	PX4_INFO("dropped samples: %u, duplicate samples: %u", (unsigned)_dropped_samples, (unsigned)_duplicate_samples);
+
+	perf_print_counter(_cycle_perf);
+	perf_print_counter(_interval_perf);
+
+	if (_fifo_mode) {
+		perf_print_counter(_fifo_perf);
+
+	} else {
+		perf_print_counter(_poll_perf);
+		perf_print_counter(_step_perf);
+	}
+
+	perf_print_counter(_publish_perf);
+	perf_print_counter(_synth_perf);
+	_latency.print();
+	return 0;
+}
+
+template<typename Core>
+void ImuFiltering::PrintFilterStatus(const Core &core)
+{
+	const ImuFilterConfig &config = core.config();
+	PX4_INFO("angular rate: %s, order %d, cutoff %.1f rad/s (%.2f Hz)", filter_family_name(config.gyro_family), config.gyro_order,
+		 config.gyro_cutoff_hz * 2.0 * M_PI, config.gyro_cutoff_hz);
+
+	if (config.angacc_fused) {
+		PX4_INFO("angular acceleration: fused with the angular rate filter");
+
+	} else {
+		PX4_INFO("angular acceleration: %s, order %d, cutoff %.1f rad/s (%.2f Hz)", filter_family_name(config.angacc_family), config.angacc_order,
+			 config.angacc_cutoff_hz * 2.0 * M_PI, config.angacc_cutoff_hz);
+	}
+
+	PX4_INFO("acceleration: %s, order %d, cutoff %.1f rad/s (%.2f Hz)", filter_family_name(config.accel_family), config.accel_order,
+		 config.accel_cutoff_hz * 2.0 * M_PI, config.accel_cutoff_hz);
+
+	if (config.jerk_fused) {
+		PX4_INFO("jerk: fused with the acceleration filter");
+
+	} else {
+		PX4_INFO("jerk: %s, order %d, cutoff %.1f rad/s (%.2f Hz)", filter_family_name(config.jerk_family), config.jerk_order,
+			 config.jerk_cutoff_hz * 2.0 * M_PI, config.jerk_cutoff_hz);
+	}
+
+	if (config.notch_count > 0) {
+		const auto &notch = core.notch();
+		PX4_INFO("dynamic notches: %d on %s, %.0f-%.0f Hz, bandwidth %.0f Hz", config.notch_count,
+			 config.notch_gyro && config.notch_accel ? "angular rate and acceleration" : config.notch_gyro ? "angular rate" : "acceleration",
+			 config.notch_min_hz, config.notch_max_hz, config.notch_bandwidth_hz);
+
+		for (int i = 0; i < notch.count(); i++) {
+			PX4_INFO("notch %d: %.1f Hz", i, (double)notch.center(i));
+		}
+	}
+
+	if (core.spectrum().reports() > 0) {
+		// attenuation of everything above the cutoffs, from the last report, of the first IMU
+		const typename Core::Spectrum::Report &report = core.spectrum().report();
+		PX4_INFO("noise above cutoff: angular rate %.3g -> %.3g (rad/s)^2, acceleration %.3g -> %.3g (m/s^2)^2",
+			 (double)report.noise_in[0], (double)report.noise_out[0], (double)report.noise_in[1], (double)report.noise_out[1]);
+	}
+
+	PX4_INFO("coefficient cache: %u hits, %u misses", (unsigned)core.cache().hits(), (unsigned)core.cache().misses());
+}
+
+bool ImuFiltering::init()
+{
+	parameters_update(true);
+
+	// move to the selected work queue before any callback can schedule Run()
+	switch (_param_sfilt_wq.get()) {
+	case 1:
+		ChangeWorkQueue(px4::wq_configurations::rate_ctrl);
+		break;
+
+	case 2:
+		ChangeWorkQueue(px4::wq_configurations::INS0);
+		break;
+
+	default:
+		break;
+	}
+
+	_multi_mode = _param_sfilt_multi.get();
+
+	if (_multi_mode) {
+		_multi_core = new MultiCore();
+
+		if (_multi_core == nullptr) {
+			PX4_ERR("alloc failed");
+			return false;
+		}
+
+		UpdateFilters(1.0 / _step_size);
+
+		// execute Run() on every sample of every gyro, so that the others keep being filtered when
+		// the clock instance fails
+		for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+			if (!_sensor_gyro_subs[k].registerCallback()) {
+				PX4_ERR("callback registration failed");
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	_fifo_mode = _param_sfilt_fifo.get();
+
+	if (_fifo_mode) {
+		// filters are synthesized on the first batch, once the FIFO sample rate is known
+		SensorSelectionUpdate(true);
+
+		// execute Run() on every sensor_gyro_fifo publication of the selected gyro
+		if (!_sensor_gyro_fifo_sub.registerCallback()) {
+			PX4_ERR("callback registration failed");
+			return false;
+		}
+
+		return true;
+	}
+
+	UpdateFilters(1.0/_step_size);
+
+	// execute Run() on every vehicle_angular_velocity publication
+	if (!_vehicle_angular_velocity_sub.registerCallback()) {
+		PX4_ERR("callback registration failed");
+		return false;
+	}
+
+	return true;
+}
+
+ImuFilterConfig ImuFiltering::FilterConfig()
+{
+	// cutoff parameters are in rad/s
+	ImuFilterConfig config{};
+	config.gyro_family = filter_family(_param_sfilt_gyro_type.get());
+	config.gyro_order = _param_sfilt_gyro_n.get();
+	config.gyro_cutoff_hz = _param_sfilt_gyro_freq.get() / 2.0 / M_PI;
+	config.angacc_family = filter_family(_param_sfilt_aacc_type.get());
+	config.angacc_order = _param_sfilt_aacc_n.get();
+	config.angacc_cutoff_hz = _param_sfilt_aacc_freq.get() / 2.0 / M_PI;
+	config.accel_family = filter_family(_param_sfilt_accel_type.get());
+	config.accel_order = _param_sfilt_accel_n.get();
+	config.accel_cutoff_hz = _param_sfilt_accel_freq.get() / 2.0 / M_PI;
+	config.jerk_family = filter_family(_param_sfilt_jrk_type.get());
+	config.jerk_order = _param_sfilt_jrk_n.get();
+	config.jerk_cutoff_hz = _param_sfilt_jrk_freq.get() / 2.0 / M_PI;
+	config.angacc_fused = _param_sfilt_aacc_fuse.get();
+	config.jerk_fused = _param_sfilt_jrk_fuse.get();
+	config.notch_gyro = _param_sfilt_dnf_en.get() & 1;
+	config.notch_accel = _param_sfilt_dnf_en.get() & 2;
+	config.notch_count = (config.notch_gyro || config.notch_accel) ? _param_sfilt_dnf_cnt.get() : 0;
+	config.notch_min_hz = _param_sfilt_dnf_min.get();
+	config.notch_max_hz = _param_sfilt_dnf_max.get();
+	config.notch_bandwidth_hz = _param_sfilt_dnf_bw.get();
+	config.spectrum_rate_hz = _param_sfilt_spec_rate.get();
+	return config;
+}
+
+void ImuFiltering::UpdateFilters(double sample_rate_hz)
+{
+	perf_begin(_synth_perf);
+
+	// keep the running filters if a cutoff is out of range for this rate
+	const bool valid = _multi_core != nullptr ? _multi_core->configure(FilterConfig(), sample_rate_hz)
+			   : _core.configure(FilterConfig(), sample_rate_hz);
+
+	if (!valid) {
+		PX4_WARN("invalid filter design at %.1f Hz, keeping previous coefficients", sample_rate_hz);
+	}
+
+	perf_end(_synth_perf);
+}
+
+double ImuFiltering::SampleRate() const
+{
+	return _multi_core != nullptr ? _multi_core->sampleRate() : _core.sampleRate();
+}
+
+void ImuFiltering::parameters_update(bool force)
+{
+	// check for parameter updates
+	if (_parameter_update_sub.updated() || force) {
+		// clear update
+		parameter_update_s update;
+		_parameter_update_sub.copy(&update);
+
+		const ImuFilterConfig previous = FilterConfig();
+
+		// update parameters from storage
+		updateParams();
+		_gyro_calibration.ParametersUpdate();
+		_accel_calibration.ParametersUpdate();
+
+		for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+			_gyro_calibrations[k].ParametersUpdate();
+			_accel_calibrations[k].ParametersUpdate();
+		}
+
+		// retune running filters here, outside the sample path
+		if (SampleRate() > 0.0 && FilterConfig() != previous) {
+			UpdateFilters(SampleRate());
+		}
+	}
+}
+
+ImuFiltering::ImuFiltering()
+	: ModuleParams(nullptr), ScheduledWorkItem("imu_filtering", px4::wq_configurations::lp_default)
+{
+}
+
+ImuFiltering::~ImuFiltering()
+{
+	perf_free(_cycle_perf);
+	perf_free(_interval_perf);
+	perf_free(_poll_perf);
+	perf_free(_step_perf);
+	perf_free(_publish_perf);
+	perf_free(_fifo_perf);
+	perf_free(_synth_perf);
+	delete _multi_core;
+}
+
+void ImuFiltering::Run()
+{
+	if (should_exit()) {
+		ScheduleClear();
+		exit_and_cleanup();
+		return;
+	}
+
+	perf_begin(_cycle_perf);
+	perf_count(_interval_perf);
+
+	// Check if parameters have changed, filters are retuned before the next sample
+	parameters_update();
+
+	if (_multi_mode) {
+		perf_begin(_poll_perf);
+		const bool clock_updated = PollSensors();
+		perf_end(_poll_perf);
+
+		// the other instances only update their latest sample
+		if (clock_updated) {
+			if (_timestamp_sample_last != 0 && _multi_gyro_timestamp_sample[_multi_clock] <= _timestamp_sample_last) {
+				_duplicate_samples++;
+
+			} else {
+				perf_begin(_step_perf);
+				StepMulti();
+				perf_end(_step_perf);
+
+				PublishMulti();
+			}
+		}
+
+	} else if (_fifo_mode) {
+		SensorSelectionUpdate();
+
+		// filter every queued batch, nothing is dropped between publications
+		sensor_gyro_fifo_s sensor_gyro_fifo;
+
+		while (_sensor_gyro_fifo_sub.update(&sensor_gyro_fifo)) {
+			perf_begin(_fifo_perf);
+			ProcessFifo(sensor_gyro_fifo);
+			perf_end(_fifo_perf);
+		}
+
+	} else if (_vehicle_angular_velocity_sub.updated()) {
+		perf_begin(_poll_perf);
+		PollTopics();
+		perf_end(_poll_perf);
+
+		// a republished or out of order sample is not filtered twice
+		if (_timestamp_sample_last != 0 && _vehicle_angular_velocity.timestamp_sample <= _timestamp_sample_last) {
+			_duplicate_samples++;
+
+		} else {
+			perf_begin(_step_perf);
+			Step();
+			perf_end(_step_perf);
+
+			Publish();
+		}
+	}
+
+	perf_end(_cycle_perf);
+}
+
+void ImuFiltering::PollTopics()
+{
+	if (_vehicle_angular_velocity_sub.updated()) {
+		_vehicle_angular_velocity_sub.copy(&_vehicle_angular_velocity);
+	}
+
+	// the accelerometer is resampled onto the gyro clock by keeping its latest sample
+	const bool accel_first = _vehicle_acceleration.timestamp == 0;
+
+	if (_vehicle_acceleration_sub.update(&_vehicle_acceleration) && accel_first) {
+		// the filters started on a zero acceleration, warm-start them again at the first one
+		_core.restart();
+	}
+}
+
+void ImuFiltering::Step()
+{
+	// interval to the previous sample, retunes the filters first if the rate has drifted
+	const filter_t dt_s = UpdateSampleRate(_vehicle_angular_velocity.timestamp_sample);
+	_timestamp_sample = _vehicle_angular_velocity.timestamp_sample;
+
+	filter_t x[LANES], dx[LANES];
+
+	for (int i = 0; i < 3; i++) {
+		x[GYRO + i] = _vehicle_angular_velocity.xyz[i];
+		x[ACCEL + i] = _vehicle_acceleration.xyz[i];
+	}
+
+	_core.step(x, dt_s, x, dx);
+
+	for (int i = 0; i < 3; i++) {
+		_angrate_radps[i] = x[GYRO + i];
+		_angacc_radps2[i] = dx[GYRO + i];
+		_accel_mps2[i] = x[ACCEL + i];
+		_jerk_mps3[i] = dx[ACCEL + i];
+	}
+}
+
+bool ImuFiltering::PollSensors()
+{
+	bool gyro_updated[MAX_SENSOR_COUNT] {};
+	hrt_abstime freshest = 0;
+
+	// every instance keeps its latest sample, corrected by its own calibration and board rotation
+	for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+		sensor_gyro_s sensor_gyro;
+
+		if (_sensor_gyro_subs[k].update(&sensor_gyro)) {
+			gyro_updated[k] = true;
+
+			// a first sample, one after a dropout or one of another sensor warm-starts the instance's filters
+			if (_multi_gyro_timestamp_sample[k] == 0 || sensor_gyro.timestamp_sample > _multi_gyro_timestamp_sample[k] + MULTI_TIMEOUT_US
+			    || sensor_gyro.device_id != _gyro_calibrations[k].device_id()) {
+				_multi_core->restart(k);
+			}
+
+			if (sensor_gyro.device_id != _gyro_calibrations[k].device_id()) {
+				_gyro_calibrations[k].set_device_id(sensor_gyro.device_id);
+			}
+
+			const matrix::Vector3f angrate = _gyro_calibrations[k].Correct(matrix::Vector3f{sensor_gyro.x, sensor_gyro.y, sensor_gyro.z});
+
+			for (int i = 0; i < 3; i++) {
+				_multi_gyro[k][i] = angrate(i);
+			}
+
+			_multi_gyro_timestamp_sample[k] = sensor_gyro.timestamp_sample;
+		}
+
+		sensor_accel_s sensor_accel;
+
+		if (_sensor_accel_subs[k].update(&sensor_accel)) {
+			if (_multi_accel_timestamp_sample[k] == 0 || sensor_accel.timestamp_sample > _multi_accel_timestamp_sample[k] + MULTI_TIMEOUT_US
+			    || sensor_accel.device_id != _accel_calibrations[k].device_id()) {
+				_multi_core->restart(k);
+			}
+
+			if (sensor_accel.device_id != _accel_calibrations[k].device_id()) {
+				_accel_calibrations[k].set_device_id(sensor_accel.device_id);
+			}
+
+			const matrix::Vector3f accel = _accel_calibrations[k].Correct(matrix::Vector3f{sensor_accel.x, sensor_accel.y, sensor_accel.z});
+
+			for (int i = 0; i < 3; i++) {
+				_multi_accel[k][i] = accel(i);
+			}
+
+			_multi_accel_timestamp_sample[k] = sensor_accel.timestamp_sample;
+		}
+
+		freshest = math::max(freshest, _multi_gyro_timestamp_sample[k]);
+	}
+
+	// a clock instance that falls a few intervals behind the freshest gyro, e.g. a failed IMU, hands
+	// the clock to the next instance that is still publishing, soon enough for the interval to the
+	// last step to count as dropped samples rather than as a gap that restarts every filter
+	const hrt_abstime clock_timeout_us = static_cast<hrt_abstime>(CLOCK_TIMEOUT_SAMPLES * _step_size * 1e6f);
+
+	if (_multi_gyro_timestamp_sample[_multi_clock] + clock_timeout_us < freshest) {
+		for (int i = 1; i < MAX_SENSOR_COUNT; i++) {
+			const int k = (_multi_clock + i) % MAX_SENSOR_COUNT;
+
+			if (_multi_gyro_timestamp_sample[k] + clock_timeout_us >= freshest) {
+				_multi_clock = k;
+				break;
+			}
+		}
+	}
+
+	return gyro_updated[_multi_clock];
+}
+
+void ImuFiltering::StepMulti()
+{
+	// the clock instance sets the clock, the other instances are resampled onto it by keeping their
+	// latest sample, as the accelerometer is in the other modes
+	const filter_t dt_s = UpdateSampleRate(_multi_gyro_timestamp_sample[_multi_clock]);
+	_timestamp_sample = _multi_gyro_timestamp_sample[_multi_clock];
+
+	filter_t x[MultiCore::LANES], dx[MultiCore::LANES];
+
+	for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+		for (int i = 0; i < 3; i++) {
+			x[k * LANES + GYRO + i] = _multi_gyro[k][i];
+			x[k * LANES + ACCEL + i] = _multi_accel[k][i];
+		}
+	}
+
+	_multi_core->step(x, dt_s, x, dx);
+
+	for (int k = 0; k < MAX_SENSOR_COUNT; k++) {
+		gyro_filtered_data_s &gyro = _multi_gyro_filtered_data[k];
+		accel_filtered_data_s &accel = _multi_accel_filtered_data[k];
+
+		for (int i = 0; i < 3; i++) {
+			gyro.angrate_radps[i] = x[k * LANES + GYRO + i];
+			gyro.angacc_radps2[i] = dx[k * LANES + GYRO + i];
+			accel.accel_mps2[i] = x[k * LANES + ACCEL + i];
+			accel.jerk_mps3[i] = dx[k * LANES + ACCEL + i];
+		}
+
+		gyro.timestamp_sample = _multi_gyro_timestamp_sample[k];
+		gyro.device_id = _gyro_calibrations[k].device_id();
+		accel.timestamp_sample = _multi_gyro_timestamp_sample[k];
+		accel.device_id = _accel_calibrations[k].device_id();
+	}
+}
+
+float ImuFiltering::UpdateSampleRate(hrt_abstime timestamp_sample)
+{
+	const hrt_abstime timestamp_sample_last = _timestamp_sample_last;
+	_timestamp_sample_last = timestamp_sample;
+
+	if (timestamp_sample_last == 0 || timestamp_sample <= timestamp_sample_last) {
+		return 0;
+	}
+
+	const float dt_s = (timestamp_sample - timestamp_sample_last) * 1e-6f;
+
+	if (dt_s > 1.5f * _step_size) {
+		_dropped_samples += static_cast<uint32_t>(roundf(dt_s / _step_size)) - 1;
+	}
+
+	if (dt_s > 10 * _step_size) {
+		// sample gap, e.g. a sensor dropout, is neither a derivative step nor part of the rate estimate
+		_dt_sum_s = 0;
+		_dt_count = 0;
+		return 0;
+	}
+
+	// average the interval over about one second, and retune when it drifts past RATE_TOLERANCE
+	_dt_sum_s += dt_s;
+	_dt_count++;
+
+	if (_dt_sum_s >= 1) {
+		const double sample_rate_hz = _dt_count / static_cast<double>(_dt_sum_s);
+		_step_size = _dt_sum_s / _dt_count;
+
+		if (fabs(sample_rate_hz - SampleRate()) > RATE_TOLERANCE * SampleRate()) {
+			UpdateFilters(sample_rate_hz);
+		}
+
+		_dt_sum_s = 0;
+		_dt_count = 0;
+	}
+
+	return dt_s;
+}
+
+void ImuFiltering::SensorSelectionUpdate(bool force)
+{
+	if (_sensor_selection_sub.updated() || force) {
+		sensor_selection_s sensor_selection{};
+		_sensor_selection_sub.copy(&sensor_selection);
+
+		// switch to the FIFO instances of newly selected sensors
+		if (sensor_selection.gyro_device_id != 0 && sensor_selection.gyro_device_id != _gyro_calibration.device_id()) {
+			for (uint8_t i = 0; i < MAX_SENSOR_COUNT; i++) {
+				uORB::SubscriptionData<sensor_gyro_fifo_s> sensor_gyro_fifo_sub{ORB_ID(sensor_gyro_fifo), i};
+
+				if (sensor_gyro_fifo_sub.get().device_id == sensor_selection.gyro_device_id) {
+					_sensor_gyro_fifo_sub.ChangeInstance(i);
+					_gyro_calibration.set_device_id(sensor_selection.gyro_device_id);
+					_fifo_dt_us = 0.f; // resynthesize for the rate of the new sensor
+					break;
+				}
+			}
+		}
+
+		if (sensor_selection.accel_device_id != 0 && sensor_selection.accel_device_id != _accel_calibration.device_id()) {
+			for (uint8_t i = 0; i < MAX_SENSOR_COUNT; i++) {
+				uORB::SubscriptionData<sensor_accel_fifo_s> sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo), i};
+
+				if (sensor_accel_fifo_sub.get().device_id == sensor_selection.accel_device_id) {
+					_sensor_accel_fifo_sub.ChangeInstance(i);
+					_accel_calibration.set_device_id(sensor_selection.accel_device_id);
+					break;
+				}
+			}
+		}
+	}
+}
+
+void ImuFiltering::ProcessFifo(const sensor_gyro_fifo_s &sensor_gyro_fifo)
+{
+	int n = math::min(static_cast<int>(sensor_gyro_fifo.samples), FIFO_MAX_SAMPLES);
+
+	if (n <= 0 || !(sensor_gyro_fifo.dt > 0.f)) {
+		return;
+	}
+
+	if (sensor_gyro_fifo.device_id != _gyro_calibration.device_id()) {
+		_gyro_calibration.set_device_id(sensor_gyro_fifo.device_id);
+	}
+
+	// consecutive batches are n samples of dt apart, a larger step means samples were lost
+	if (_timestamp_sample_last != 0 && sensor_gyro_fifo.device_id == _fifo_device_id) {
+		if (sensor_gyro_fifo.timestamp_sample <= _timestamp_sample_last) {
+			_duplicate_samples += n;
+			return;
+		}
+
+		const float samples = (sensor_gyro_fifo.timestamp_sample - _timestamp_sample_last) / sensor_gyro_fifo.dt;
+
+		if (samples > n + 0.5f) {
+			_dropped_samples += static_cast<uint32_t>(roundf(samples)) - n;
+		}
+
+		if (samples > n + 10) {
+			// sample gap, e.g. a sensor dropout, the filters warm-start at the batch instead
+			_core.restart();
+		}
+
+	} else if (_timestamp_sample_last != 0) {
+		// failover to another gyro, the filter state belongs to the previous one
+		_core.restart();
+	}
+
+	_timestamp_sample_last = sensor_gyro_fifo.timestamp_sample;
+	_fifo_device_id = sensor_gyro_fifo.device_id;
+
+	if (sensor_gyro_fifo.dt != _fifo_dt_us) {
+		// filters run at the gyro rate divided by SFILT_DEC, outputs are decimated further to SFILT_RATE
+		_core.setDecimation(_param_sfilt_dec.get());
+
+		const double sample_rate_hz = 1e6 / sensor_gyro_fifo.dt / _core.decimation();
+		UpdateFilters(sample_rate_hz);
+		_decimation = math::max(1, static_cast<int>(roundf(static_cast<float>(sample_rate_hz) / _param_sfilt_rate.get())));
+		_decimation_count = 0;
+		_fifo_dt_us = sensor_gyro_fifo.dt;
+	}
+
+	// The gyro batch sets the clock. The latest accelerometer batch is spread over it by zero-order
+	// hold, which is exact when both FIFOs run at the same rate, and the last accelerometer sample
+	// is held while no new batch has arrived.
+	sensor_accel_fifo_s sensor_accel_fifo;
+	int accel_samples = 0;
+
+	if (_sensor_accel_fifo_sub.update(&sensor_accel_fifo)) {
+		accel_samples = math::min(static_cast<int>(sensor_accel_fifo.samples), FIFO_MAX_SAMPLES);
+
+		if (sensor_accel_fifo.device_id != _accel_calibration.device_id()) {
+			_accel_calibration.set_device_id(sensor_accel_fifo.device_id);
+		}
+
+		if (sensor_accel_fifo.device_id != _accel_fifo_device_id) {
+			// the first accelerometer batch, or one of another sensor, replaces the held sample
+			_core.restart();
+			_accel_fifo_device_id = sensor_accel_fifo.device_id;
+		}
+	}
+
+	// scale, then apply the calibration and board rotation of the selected sensors
+	int accel_index = -1;
+
+	for (int t = 0; t < n; t++) {
+		const matrix::Vector3f gyro_raw{static_cast<float>(sensor_gyro_fifo.x[t]), static_cast<float>(sensor_gyro_fifo.y[t]), static_cast<float>(sensor_gyro_fifo.z[t])};
+		const matrix::Vector3f angrate = _gyro_calibration.Correct(gyro_raw * sensor_gyro_fifo.scale);
+
+		if (accel_samples > 0 && t * accel_samples / n != accel_index) {
+			accel_index = t * accel_samples / n;
+			const matrix::Vector3f accel_raw{static_cast<float>(sensor_accel_fifo.x[accel_index]), static_cast<float>(sensor_accel_fifo.y[accel_index]), static_cast<float>(sensor_accel_fifo.z[accel_index])};
+			const matrix::Vector3f accel = _accel_calibration.Correct(accel_raw * sensor_accel_fifo.scale);
+
+			for (int i = 0; i < 3; i++) {
+				_accel_hold[i] = accel(i);
+			}
+		}
+
+		for (int i = 0; i < 3; i++) {
+			_fifo[t * LANES + GYRO + i] = angrate(i);
+			_fifo[t * LANES + ACCEL + i] = _accel_hold[i];
+		}
+	}
+
+	n = static_cast<int>(_core.processBuffer(_fifo, _fifo_derivative, n, sensor_gyro_fifo.dt * 1e-6f));
+
+	// timestamp_sample is the time of the last sample in the batch, the decimator may hold back a few
+	const float row_dt_us = sensor_gyro_fifo.dt * _core.decimation();
+	const hrt_abstime timestamp_sample_last = sensor_gyro_fifo.timestamp_sample - static_cast<hrt_abstime>(_core.pending() * sensor_gyro_fifo.dt);
+
+	for (int t = 0; t < n; t++) {
+		if (++_decimation_count < _decimation) {
+			continue;
+		}
+
+		_decimation_count = 0;
+		_timestamp_sample = timestamp_sample_last - static_cast<hrt_abstime>((n - 1 - t) * row_dt_us);
+
+		for (int i = 0; i < 3; i++) {
+			_angrate_radps[i] = _fifo[t * LANES + GYRO + i];
+			_angacc_radps2[i] = _fifo_derivative[t * LANES + GYRO + i];
+			_accel_mps2[i] = _fifo[t * LANES + ACCEL + i];
+			_jerk_mps3[i] = _fifo_derivative[t * LANES + ACCEL + i];
+		}
+
+		Publish();
+	}
+}
+
+int ImuFiltering::custom_command(int argc, char *argv[])
+{
+	return print_usage("unknown command");
+}
+
+int ImuFiltering::print_usage(const char *reason)
+{
+	if (reason) {
+		PX4_WARN("%s\n", reason);
+	}
+
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Filters angular velocity and linear acceleration in a single work item, and publishes
+gyro_filtered_data and accel_filtered_data with the angular acceleration and linear jerk.
+Runs on every vehicle_angular_velocity update, with the latest vehicle_acceleration sample.
+
+With SFILT_FIFO enabled, the raw sensor_gyro_fifo and sensor_accel_fifo batches of the selected
+sensors are filtered at the full gyro rate, and both topics are published at SFILT_RATE.
+
+SFILT_WQ moves the module from lp_default to the rate_ctrl or INS0 work queue, so that the
+filtered outputs are not delayed behind low-priority work. `imu_filtering status` prints a
+histogram of the delay from sensor sample to publication.
+
+With SFILT_MULTI enabled, every sensor_gyro and sensor_accel instance is filtered with its own
+calibration in one pass, and each IMU is published as its own gyro_filtered_data and
+accel_filtered_data instance, identified by device_id.
+
+With SFILT_SPEC_RATE above 0, imu_filter_spectrum reports the vibration spectrum of both sensors
+before and after filtering, and their power above the low-pass cutoffs.
+
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("imu_filtering", "modules");
+	PRINT_MODULE_USAGE_COMMAND("start");
+	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
+
+	return 0;
+}
+
+extern "C" __EXPORT int imu_filtering_main(int argc, char *argv[])
+{
+	return ImuFiltering::main(argc, argv);
+}
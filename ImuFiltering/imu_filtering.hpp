@@ -0,0 +1,269 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+#pragma once
+
+#include <px4_platform_common/defines.h>
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/module.h>
+#include <px4_platform_common/module_params.h>
+#include <px4_platform_common/posix.h>
+#include <px4_platform_common/px4_work_queue/ScheduledWorkItem.hpp>
+
+#include <uORB/SubscriptionInterval.hpp>
+#include <uORB/topics/parameter_update.h>
+#include <uORB/topics/gyro_filtered_data.h>
+#include <uORB/topics/accel_filtered_data.h>
+#include <uORB/topics/imu_filter_spectrum.h>
+#include <uORB/Publication.hpp>
+#include <uORB/PublicationMulti.hpp>
+#include <uORB/Subscription.hpp>
+#include <uORB/SubscriptionCallback.hpp>
+#include <uORB/SubscriptionData.hpp>
+#include <uORB/topics/vehicle_angular_velocity.h>
+#include <uORB/topics/vehicle_acceleration.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
+#include <uORB/topics/sensor_accel_fifo.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_selection.h>
+#include <lib/mathlib/mathlib.h>
+#include <lib/perf/perf_counter.h>
+#include <lib/matrix/matrix/math.hpp>
+#include <lib/sensor_calibration/Accelerometer.hpp>
+#include <lib/sensor_calibration/Gyroscope.hpp>
+#include "ImuFilterCore.hpp"
+
+using namespace time_literals;
+
+// Histogram of the delay from sensor sample to publication
+class LatencyHistogram
+{
+public:
+	static constexpr int BINS = 8;
+	static constexpr uint32_t EDGES_US[BINS - 1] {100, 200, 500, 1000, 2000, 5000, 10000}; // upper bin edges
+
+	void record(hrt_abstime latency_us)
+	{
+		int bin = 0;
+
+		while (bin < BINS - 1 && latency_us >= EDGES_US[bin]) {
+			bin++;
+		}
+
+		_count[bin]++;
+		_total++;
+		_sum_us += latency_us;
+		_max_us = math::max(_max_us, latency_us);
+	}
+
+	void print() const;
+
+private:
+	uint32_t _count[BINS] {};
+	uint32_t _total{0};
+	uint64_t _sum_us{0};
+	hrt_abstime _max_us{0};
+};
+
+// Filters the angular velocity and the linear acceleration in one work item. Run() is triggered by
+// the gyro, the latest accelerometer data is taken in the same callback, and both topics are
+// published together. The filtering itself is done by ImuFilterCore, this class feeds it from
+// uORB and publishes its outputs. With SFILT_MULTI, every IMU is filtered by one ImuFilterCore
+// over all of them, and each gets its own instance of both topics.
+class ImuFiltering : public ModuleBase<ImuFiltering>, public ModuleParams, public px4::ScheduledWorkItem
+{
+public:
+	ImuFiltering();
+
+	~ImuFiltering() override;
+
+	/** @see ModuleBase */
+	static int task_spawn(int argc, char *argv[]);
+
+	/** @see ModuleBase */
+	static int custom_command(int argc, char *argv[]);
+
+	/** @see ModuleBase */
+	static int print_usage(const char *reason = nullptr);
+
+	/** @see ModuleBase::print_status() */
+	int print_status() override;
+
+	bool init();
+
+private:
+
+	void Run() override;
+
+	/**
+	 * Check for parameter changes and update them if needed.
+	 * @param parameter_update_sub uorb subscription to parameter_update
+	 * @param force for a parameter update
+	 */
+	void parameters_update(bool force = false);
+	inline void Publish();
+	inline void Step();
+	inline void PollTopics();
+	void UpdateFilters(double sample_rate_hz);
+	ImuFilterConfig FilterConfig();
+	float UpdateSampleRate(hrt_abstime timestamp_sample);
+	void SensorSelectionUpdate(bool force = false);
+	void ProcessFifo(const sensor_gyro_fifo_s &sensor_gyro_fifo);
+	inline bool PollSensors();
+	inline void StepMulti();
+	inline void PublishMulti();
+	double SampleRate() const;
+
+	template<typename Core>
+	void PrintFilterStatus(const Core &core);
+
+	template<typename Core>
+	void PublishSpectrum(const Core &core);
+
+#if defined(CONFIG_IMU_FILTERING_FLOAT)
+	using filter_t = float; // single-precision filters for boards without a double-precision FPU
+#else
+	using filter_t = double;
+#endif
+	static constexpr int MAX_SENSOR_COUNT = 4;
+
+	using FilterCore = ImuFilterCore<filter_t>;
+	using MultiCore = ImuFilterCore<filter_t, MAX_SENSOR_COUNT>; // all instances, one IMU after the other in a row
+
+	static constexpr int GYRO = FilterCore::GYRO; // first lane of each sensor in a row
+	static constexpr int ACCEL = FilterCore::ACCEL;
+	static constexpr int LANES = FilterCore::LANES;
+
+	float _angrate_radps[3] {0.0, 0.0, 0.0};
+	float _angacc_radps2[3] {0.0, 0.0, 0.0};
+	float _accel_mps2[3] {0.0, 0.0, 0.0};
+	float _jerk_mps3[3] {0.0, 0.0, 0.0};
+
+	hrt_abstime _timestamp_sample{0}; // gyro sample time of the outputs, accel is resampled onto the gyro clock
+	LatencyHistogram _latency{};
+
+	// Mean sample interval, measured from timestamp_sample. The filters are synthesized for 400 Hz
+	// at start, and resynthesized whenever the measured rate differs by more than RATE_TOLERANCE.
+	static constexpr double RATE_TOLERANCE = 0.01;
+	filter_t _step_size{0.0025}; // 400 Hz
+	hrt_abstime _timestamp_sample_last{0};
+	filter_t _dt_sum_s{0}; // intervals accumulated for the rate estimate
+	int _dt_count{0};
+
+	FilterCore _core{}; // filters, notches, their coefficient cache and the FIFO decimator
+	unsigned _spectrum_reports{0}; // spectrum reports of _core published so far
+
+	vehicle_angular_velocity_s _vehicle_angular_velocity{};
+	vehicle_acceleration_s _vehicle_acceleration{};
+
+	// FIFO input mode, raw samples of the selected sensors filtered at the sensor rate
+	static constexpr int FIFO_MAX_SAMPLES = 32; // sensor_gyro_fifo_s::x capacity
+
+	calibration::Gyroscope _gyro_calibration{};
+	calibration::Accelerometer _accel_calibration{};
+	filter_t _fifo[FIFO_MAX_SAMPLES * LANES] {}; // row-major, one row per sample
+	filter_t _fifo_derivative[FIFO_MAX_SAMPLES * LANES] {};
+	float _accel_hold[3] {}; // latest accelerometer sample, held until the next batch
+	float _fifo_dt_us{0.f}; // sample interval the filters were synthesized for
+	uint32_t _fifo_device_id{0}; // gyro of the last batch, batches of different sensors are not compared
+	uint32_t _accel_fifo_device_id{0}; // accelerometer of the last batch, 0 before the first
+	int _decimation{1}; // publish every _decimation-th filtered sample
+	int _decimation_count{0};
+	bool _fifo_mode{false};
+
+	// Multi-IMU input mode, every sensor_gyro and sensor_accel instance with its own calibration. The
+	// bank is allocated only in this mode, it is about four times the size of _core.
+	static constexpr hrt_abstime MULTI_TIMEOUT_US{100_ms}; // an instance without newer samples is not published
+	static constexpr int CLOCK_TIMEOUT_SAMPLES{4}; // intervals the clock instance may fall behind the freshest gyro
+
+	MultiCore *_multi_core{nullptr};
+	calibration::Gyroscope _gyro_calibrations[MAX_SENSOR_COUNT] {};
+	calibration::Accelerometer _accel_calibrations[MAX_SENSOR_COUNT] {};
+	float _multi_gyro[MAX_SENSOR_COUNT][3] {}; // latest corrected sample of each instance
+	float _multi_accel[MAX_SENSOR_COUNT][3] {};
+	hrt_abstime _multi_gyro_timestamp_sample[MAX_SENSOR_COUNT] {}; // of the latest sample, 0 before the first
+	hrt_abstime _multi_accel_timestamp_sample[MAX_SENSOR_COUNT] {};
+	gyro_filtered_data_s _multi_gyro_filtered_data[MAX_SENSOR_COUNT] {};
+	accel_filtered_data_s _multi_accel_filtered_data[MAX_SENSOR_COUNT] {};
+	int _multi_clock{0}; // gyro instance whose samples are filtered, the others are resampled onto it
+	bool _multi_mode{false};
+
+	uint32_t _dropped_samples{0}; // samples missing between two inputs, from timestamp_sample
+	uint32_t _duplicate_samples{0}; // inputs skipped because timestamp_sample did not advance
+
+	perf_counter_t _cycle_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": cycle")};
+	perf_counter_t _interval_perf{perf_alloc(PC_INTERVAL, MODULE_NAME": interval")};
+	perf_counter_t _poll_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": poll")};
+	perf_counter_t _step_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": step")};
+	perf_counter_t _publish_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": publish")};
+	perf_counter_t _fifo_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": fifo batch")};
+	perf_counter_t _synth_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": synthesis")};
+
+	DEFINE_PARAMETERS(
+		(ParamInt<px4::params::SFILT_GYRO_N>) _param_sfilt_gyro_n,
+		(ParamFloat<px4::params::SFILT_GYRO_FREQ>) _param_sfilt_gyro_freq,
+		(ParamInt<px4::params::SFILT_AACC_N>) _param_sfilt_aacc_n,
+		(ParamFloat<px4::params::SFILT_AACC_FREQ>) _param_sfilt_aacc_freq,
+		(ParamInt<px4::params::SFILT_ACCEL_N>) _param_sfilt_accel_n,
+		(ParamFloat<px4::params::SFILT_ACCEL_FREQ>) _param_sfilt_accel_freq,
+		(ParamInt<px4::params::SFILT_JRK_N>) _param_sfilt_jrk_n,
+		(ParamFloat<px4::params::SFILT_JRK_FREQ>) _param_sfilt_jrk_freq,
+		(ParamInt<px4::params::SFILT_GYRO_TYPE>) _param_sfilt_gyro_type,
+		(ParamInt<px4::params::SFILT_AACC_TYPE>) _param_sfilt_aacc_type,
+		(ParamInt<px4::params::SFILT_ACCEL_TYPE>) _param_sfilt_accel_type,
+		(ParamInt<px4::params::SFILT_JRK_TYPE>) _param_sfilt_jrk_type,
+		(ParamBool<px4::params::SFILT_AACC_FUSE>) _param_sfilt_aacc_fuse,
+		(ParamBool<px4::params::SFILT_JRK_FUSE>) _param_sfilt_jrk_fuse,
+		(ParamInt<px4::params::SFILT_DNF_EN>) _param_sfilt_dnf_en,
+		(ParamInt<px4::params::SFILT_DNF_CNT>) _param_sfilt_dnf_cnt,
+		(ParamFloat<px4::params::SFILT_DNF_MIN>) _param_sfilt_dnf_min,
+		(ParamFloat<px4::params::SFILT_DNF_MAX>) _param_sfilt_dnf_max,
+		(ParamFloat<px4::params::SFILT_DNF_BW>) _param_sfilt_dnf_bw,
+		(ParamFloat<px4::params::SFILT_SPEC_RATE>) _param_sfilt_spec_rate,
+		(ParamBool<px4::params::SFILT_FIFO>) _param_sfilt_fifo,
+		(ParamFloat<px4::params::SFILT_RATE>) _param_sfilt_rate,
+		(ParamInt<px4::params::SFILT_DEC>) _param_sfilt_dec,
+		(ParamBool<px4::params::SFILT_MULTI>) _param_sfilt_multi,
+		(ParamInt<px4::params::SFILT_WQ>) _param_sfilt_wq
+	)
+
+	// Subscriptions
+	uORB::SubscriptionInterval _parameter_update_sub{ORB_ID(parameter_update), 1_s};
+
+	uORB::Publication<gyro_filtered_data_s> _gyro_filtered_data_pub{ORB_ID(gyro_filtered_data)};
+	uORB::Publication<accel_filtered_data_s> _accel_filtered_data_pub{ORB_ID(accel_filtered_data)};
+	uORB::Publication<imu_filter_spectrum_s> _imu_filter_spectrum_pub{ORB_ID(imu_filter_spectrum)};
+	gyro_filtered_data_s _gyro_filtered_data{};
+	accel_filtered_data_s _accel_filtered_data{};
+	uORB::SubscriptionCallbackWorkItem _vehicle_angular_velocity_sub{this, ORB_ID(vehicle_angular_velocity)};
+	uORB::Subscription _vehicle_acceleration_sub{ORB_ID(vehicle_acceleration)};
+	uORB::SubscriptionCallbackWorkItem _sensor_gyro_fifo_sub{this, ORB_ID(sensor_gyro_fifo)};
+	uORB::Subscription _sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo)};
+	uORB::Subscription _sensor_selection_sub{ORB_ID(sensor_selection)};
+
+	// multi-IMU mode, Run() is triggered by every gyro instance and steps on the clock instance
+	uORB::SubscriptionCallbackWorkItem _sensor_gyro_subs[MAX_SENSOR_COUNT] {
+		{this, ORB_ID(sensor_gyro), 0},
+		{this, ORB_ID(sensor_gyro), 1},
+		{this, ORB_ID(sensor_gyro), 2},
+		{this, ORB_ID(sensor_gyro), 3},
+	};
+	uORB::Subscription _sensor_accel_subs[MAX_SENSOR_COUNT] {
+		{ORB_ID(sensor_accel), 0},
+		{ORB_ID(sensor_accel), 1},
+		{ORB_ID(sensor_accel), 2},
+		{ORB_ID(sensor_accel), 3},
+	};
+	uORB::PublicationMulti<gyro_filtered_data_s> _gyro_filtered_data_multi_pub[MAX_SENSOR_COUNT] {
+		{ORB_ID(gyro_filtered_data)},
+		{ORB_ID(gyro_filtered_data)},
+		{ORB_ID(gyro_filtered_data)},
+		{ORB_ID(gyro_filtered_data)},
+	};
+	uORB::PublicationMulti<accel_filtered_data_s> _accel_filtered_data_multi_pub[MAX_SENSOR_COUNT] {
+		{ORB_ID(accel_filtered_data)},
+		{ORB_ID(accel_filtered_data)},
+		{ORB_ID(accel_filtered_data)},
+		{ORB_ID(accel_filtered_data)},
+	};
+};
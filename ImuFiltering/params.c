@@ -0,0 +1,330 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+/**
+ * Gyroscope Filter Order
+ *
+ * Order of the filter applied to the gyroscope data.
+ *
+ * @min 1
+ * @max 10
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_GYRO_N, 2);
+
+/**
+ * Angular Acceleration Filter Order
+ *
+ * Order of the filter applied to the angular acceleration data.
+ *
+ * @min 1
+ * @max 10
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_AACC_N, 2);
+
+/**
+ * Gyroscope Filter Cutoff Frequency
+ *
+ * Cutoff frequency of the filter applied to the gyroscope data, in rad/s.
+ *
+ * @min 1
+ * @max 400
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_GYRO_FREQ, 50.0f);
+
+/**
+ * Angular Acceleration Filter Cutoff Frequency
+ *
+ * Cutoff frequency of the filter applied to the angular acceleration data, in rad/s.
+ *
+ * @min 1
+ * @max 400
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_AACC_FREQ, 50.0f);
+
+/**
+ * Accelerometer Filter Order
+ *
+ * Order of the filter applied to the accelerometer data.
+ *
+ * @min 1
+ * @max 10
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_ACCEL_N, 2);
+
+/**
+ * Linear Jerk Filter Order
+ *
+ * Order of the filter applied to the linear jerk data.
+ *
+ * @min 1
+ * @max 10
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_JRK_N, 2);
+
+/**
+ * Accelerometer Filter Cutoff Frequency
+ *
+ * Cutoff frequency of the filter applied to the accelerometer data, in rad/s.
+ *
+ * @min 1
+ * @max 400
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_ACCEL_FREQ, 70.0f);
+
+/**
+ * Linear Jerk Filter Cutoff Frequency
+ *
+ * Cutoff frequency of the filter applied to the linear jerk data, in rad/s.
+ *
+ * @min 1
+ * @max 400
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_JRK_FREQ, 70.0f);
+
+/**
+ * Gyroscope Filter Type
+ *
+ * Family of the filter applied to the gyroscope data. Chebyshev II cannot be used with SFILT_AACC_FUSE.
+ *
+ * @value 0 Butterworth
+ * @value 1 Bessel
+ * @value 2 Chebyshev I
+ * @value 3 Chebyshev II
+ * @value 4 Critically damped
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_GYRO_TYPE, 0);
+
+/**
+ * Angular Acceleration Filter Type
+ *
+ * Family of the filter applied to the angular acceleration data.
+ *
+ * @value 0 Butterworth
+ * @value 1 Bessel
+ * @value 2 Chebyshev I
+ * @value 3 Chebyshev II
+ * @value 4 Critically damped
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_AACC_TYPE, 0);
+
+/**
+ * Accelerometer Filter Type
+ *
+ * Family of the filter applied to the accelerometer data. Chebyshev II cannot be used with SFILT_JRK_FUSE.
+ *
+ * @value 0 Butterworth
+ * @value 1 Bessel
+ * @value 2 Chebyshev I
+ * @value 3 Chebyshev II
+ * @value 4 Critically damped
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_ACCEL_TYPE, 0);
+
+/**
+ * Linear Jerk Filter Type
+ *
+ * Family of the filter applied to the linear jerk data.
+ *
+ * @value 0 Butterworth
+ * @value 1 Bessel
+ * @value 2 Chebyshev I
+ * @value 3 Chebyshev II
+ * @value 4 Critically damped
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_JRK_TYPE, 0);
+
+/**
+ * Fused Angular Acceleration Filter
+ *
+ * Take the angular acceleration from the angular rate filter, as the derivative of its output
+ * computed from the same filter state, instead of differencing the filtered angular rate and
+ * filtering it again. Removes the delay of the angular acceleration filter. SFILT_AACC_N and
+ * SFILT_AACC_FREQ are unused when enabled.
+ *
+ * @boolean
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_AACC_FUSE, 0);
+
+/**
+ * Fused Linear Jerk Filter
+ *
+ * Take the linear jerk from the accelerometer filter, as the derivative of its output computed
+ * from the same filter state, instead of differencing the filtered acceleration and filtering it
+ * again. Removes the delay of the jerk filter. SFILT_JRK_N and SFILT_JRK_FREQ are unused when
+ * enabled.
+ *
+ * @boolean
+ * @group Accel Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_JRK_FUSE, 0);
+
+/**
+ * Dynamic Notch Filters
+ *
+ * Sensors whose data passes through tracking notch filters ahead of the low-pass filters. The
+ * notches follow the strongest vibration peaks of the angular rate between SFILT_DNF_MIN and
+ * SFILT_DNF_MAX, which lets the low-pass cutoffs be raised for less delay. Most useful with
+ * SFILT_FIFO, as vehicle_angular_velocity is already low-pass filtered by the sensors module.
+ *
+ * @min 0
+ * @max 3
+ * @bit 0 Angular rate
+ * @bit 1 Acceleration
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_DNF_EN, 0);
+
+/**
+ * Dynamic Notch Count
+ *
+ * Number of notches on each axis, each following one of the strongest peaks, e.g. a motor's
+ * fundamental and its harmonics.
+ *
+ * @min 1
+ * @max 4
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_DNF_CNT, 1);
+
+/**
+ * Dynamic Notch Minimum Frequency
+ *
+ * Lower end of the band searched for vibration peaks.
+ *
+ * @unit Hz
+ * @min 10
+ * @max 1000
+ * @decimal 0
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_DNF_MIN, 80.0f);
+
+/**
+ * Dynamic Notch Maximum Frequency
+ *
+ * Upper end of the band searched for vibration peaks, limited to 0.45 times the filter rate.
+ *
+ * @unit Hz
+ * @min 10
+ * @max 4000
+ * @decimal 0
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_DNF_MAX, 200.0f);
+
+/**
+ * Dynamic Notch Bandwidth
+ *
+ * Width of each notch between its -3 dB points. Wider notches remove peaks that spread or move
+ * quickly but add more delay below them.
+ *
+ * @unit Hz
+ * @min 1
+ * @max 100
+ * @decimal 0
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_DNF_BW, 20.0f);
+
+/**
+ * Spectrum Monitor Rate
+ *
+ * Publication rate of imu_filter_spectrum, the vibration spectrum of the angular rate and the
+ * acceleration before and after filtering, and their power above the low-pass cutoffs. The
+ * spectrum is averaged over the frames between two publications. Disabled (0) by default: the
+ * monitor runs 32 Goertzel bins on all six lanes before and after filtering, about 384
+ * multiply-accumulates per sample, which roughly doubles the filtering cost at any rate above 0.
+ *
+ * @unit Hz
+ * @min 0
+ * @max 10
+ * @decimal 1
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_SPEC_RATE, 0.0f);
+
+/**
+ * FIFO Input
+ *
+ * Filter the raw sensor_gyro_fifo and sensor_accel_fifo samples of the selected sensors at the
+ * full sensor rate instead of vehicle_angular_velocity and vehicle_acceleration. Outputs are
+ * decimated to SFILT_RATE.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_FIFO, 0);
+
+/**
+ * Filter Output Rate
+ *
+ * Publication rate of gyro_filtered_data and accel_filtered_data with SFILT_FIFO enabled, in Hz.
+ * Every n-th filtered sample is published, where n is the filter rate (sensor rate / SFILT_DEC)
+ * divided by this rate, rounded.
+ *
+ * @unit Hz
+ * @min 50
+ * @max 8000
+ * @reboot_required true
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_FLOAT(SFILT_RATE, 400.0f);
+
+/**
+ * FIFO Input Decimation
+ *
+ * Ratio by which the FIFO samples are decimated before the butterworth filters with
+ * SFILT_FIFO enabled. A half-band anti-aliasing FIR cascade runs at the sensor rate,
+ * and the butterworth filters are synthesized for the sensor rate divided by this ratio.
+ *
+ * @value 1 Off
+ * @value 2 2:1
+ * @value 4 4:1
+ * @value 8 8:1
+ * @reboot_required true
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_DEC, 1);
+
+/**
+ * Multi-IMU Input
+ *
+ * Filter every sensor_gyro and sensor_accel instance, with its calibration, instead of the
+ * selected vehicle_angular_velocity and vehicle_acceleration, and publish one gyro_filtered_data
+ * and accel_filtered_data instance per IMU with its device_id. Gyro and accelerometer instances
+ * are paired by instance number, and all IMUs are filtered together on every sample of the first
+ * gyro. SFILT_FIFO is ignored when enabled.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_MULTI, 0);
+
+/**
+ * Filter Work Queue
+ *
+ * Work queue the filters run on. rate_ctrl runs them at rate controller priority, INS0 next to
+ * the first IMU's sensor processing. Use `imu_filtering status` to check the sample to publish
+ * latency.
+ *
+ * @value 0 lp_default
+ * @value 1 rate_ctrl
+ * @value 2 INS0
+ * @reboot_required true
+ * @group Sensor Filtering
+ */
+PARAM_DEFINE_INT32(SFILT_WQ, 0);
@@ -0,0 +1,129 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Vibration spectrum of the rows going into the filters and of the rows coming out of them, to
+// check in flight that the filters remove what they were tuned for. Two GoertzelBanks over all bins
+// up to the Nyquist frequency see the same rows before and after filtering, so the cost per row is
+// the same on every row, one multiply-add per bin and lane on each side. Frames of WINDOW rows are
+// averaged into a Report every few frames.
+//
+// Bin powers are mean squares, in the squared unit of the lane: a sine of amplitude A centred on a
+// bin has A^2 / 2 over that bin and its two neighbours, and white noise sums to its variance over
+// all bins. Each group of AXES lanes, e.g. the gyro and the accelerometer axes, is summed over its
+// axes. The noise power of a group is the sum over its bins at and above the group's noise
+// frequency, typically the low-pass cutoff, where everything is meant to be attenuated.
+
+#pragma once
+#include "Goertzel.hpp"
+#include <cmath>
+#include <cstddef>
+
+template <std::size_t Lanes>
+class SpectrumMonitor {
+public:
+    static constexpr int WINDOW = 64; // rows per frame
+    static constexpr int BINS = WINDOW / 2; // bins 1 to WINDOW / 2, the last one at the Nyquist frequency
+    static constexpr int AXES = 3;
+    static constexpr std::size_t GROUPS = Lanes / AXES;
+
+    struct Report {
+        float bin_hz = 0; // bin i is at (i + 1) bin_hz
+        int frames = 0; // frames averaged
+        float in[GROUPS][BINS] = {}; // before filtering
+        float out[GROUPS][BINS] = {}; // after filtering
+        float noise_in[GROUPS] = {};
+        float noise_out[GROUPS] = {};
+    };
+
+    // A report every frames frames at sampling freq fs, 0 to disable; noise power of group g from
+    // noise_hz[g] up. Restarts the current frame and average.
+    void configure(double fs, int frames, const double noise_hz[GROUPS]) {
+        frames_ = frames < 0 ? 0 : frames;
+        bin_hz_ = static_cast<float>(fs / WINDOW);
+        for (std::size_t g = 0; g < GROUPS; ++g) {
+            int first = static_cast<int>(std::ceil(noise_hz[g] / bin_hz_)) - 1;
+            noise_first_[g] = first < 0 ? 0 : (first > BINS ? BINS : first);
+        }
+        in_.configure(1, BINS);
+        out_.configure(1, BINS);
+        clear();
+    }
+
+    bool enabled() const { return frames_ > 0; }
+
+    // n rows before filtering, stride values apart, of which the first Lanes are monitored
+    template <typename T>
+    void pushInput(const T* rows, std::size_t n, std::size_t stride = Lanes) { push(in_, sum_in_, rows, n, stride, false); }
+
+    template <typename T>
+    void pushOutput(const T* rows, std::size_t n, std::size_t stride = Lanes) { push(out_, sum_out_, rows, n, stride, true); } // The same rows after filtering
+
+    const Report& report() const { return report_; } // Last complete report
+    unsigned reports() const { return reports_; } // Reports completed, changes when a new one is ready
+
+private:
+    using Bank = GoertzelBank<static_cast<int>(Lanes), WINDOW, BINS>;
+
+    template <typename T>
+    void push(Bank& bank, float sum[GROUPS][BINS], const T* rows, std::size_t n, std::size_t stride, bool output) {
+        if (!enabled()) return;
+        std::size_t done = 0;
+        while (done < n) {
+            const std::size_t m = n - done < static_cast<std::size_t>(bank.remaining()) ? n - done : bank.remaining();
+            if (bank.push(rows + done * stride, m, stride)) {
+                accumulate(bank, sum);
+                // the input frame of the same rows is complete already
+                if (output && ++frames_done_ == frames_) publish();
+            }
+            done += m;
+        }
+    }
+
+    void accumulate(const Bank& bank, float sum[GROUPS][BINS]) const {
+        for (std::size_t g = 0; g < GROUPS; ++g) {
+            for (int k = 0; k < BINS; ++k) {
+                for (int a = 0; a < AXES; ++a) sum[g][k] += bank.power(static_cast<int>(g) * AXES + a, k);
+            }
+        }
+    }
+
+    void publish() {
+        // Hann window: sum_k |X_k|^2 over one side is 3 W^2 / 16 times the mean square
+        const float scale = 16.f / (3.f * WINDOW * WINDOW * frames_);
+        report_.bin_hz = bin_hz_;
+        report_.frames = frames_;
+        for (std::size_t g = 0; g < GROUPS; ++g) {
+            report_.noise_in[g] = 0;
+            report_.noise_out[g] = 0;
+            for (int k = 0; k < BINS; ++k) {
+                report_.in[g][k] = sum_in_[g][k] * scale;
+                report_.out[g][k] = sum_out_[g][k] * scale;
+                if (k >= noise_first_[g]) {
+                    report_.noise_in[g] += report_.in[g][k];
+                    report_.noise_out[g] += report_.out[g][k];
+                }
+            }
+        }
+        ++reports_;
+        clear();
+    }
+
+    void clear() {
+        frames_done_ = 0;
+        for (std::size_t g = 0; g < GROUPS; ++g) {
+            for (int k = 0; k < BINS; ++k) {
+                sum_in_[g][k] = 0;
+                sum_out_[g][k] = 0;
+            }
+        }
+    }
+
+    Bank in_ {}, out_ {};
+    float sum_in_[GROUPS][BINS] = {}; // |X|^2 summed over the frames of the current report
+    float sum_out_[GROUPS][BINS] = {};
+    Report report_ {};
+    float bin_hz_ = 0;
+    int noise_first_[GROUPS] = {}; // first bin of each group's noise band
+    int frames_ = 0;
+    int frames_done_ = 0;
+    unsigned reports_ = 0;
+};
@@ -0,0 +1,166 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// The IMU topics of a flight log as the imu_filtering module sees them: field offsets of
+// vehicle_angular_velocity and vehicle_acceleration, the module's sample rate tracking, and a
+// decoder of a whole log into filter rows held in memory for tools that run it many times.
+
+#pragma once
+#include "ImuFilterCore.hpp"
+#include "ULog.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Offsets of the fields read from an IMU topic, from its logged format
+struct ImuLayout {
+    int id = -1; // message id of the subscription, -1 until subscribed
+    std::size_t timestamp = 0;
+    std::size_t timestamp_sample = 0;
+    std::size_t xyz = 0;
+    std::size_t size = 0;
+
+    bool resolve(ulog::ULogReader& reader, const char* topic, int id_) {
+        const ulog::Format* f = reader.format(topic);
+        if (f == nullptr) return false;
+        const ulog::Field* t = f->field("timestamp");
+        const ulog::Field* ts = f->field("timestamp_sample");
+        const ulog::Field* v = f->field("xyz");
+        if (t == nullptr || t->type != "uint64_t" || v == nullptr || v->type != "float" || v->count != 3) return false;
+        id = id_;
+        timestamp = t->offset;
+        timestamp_sample = ts != nullptr && ts->type == "uint64_t" ? ts->offset : t->offset; // older logs
+        xyz = v->offset;
+        size = f->size;
+        return true;
+    }
+};
+
+// ImuFiltering::UpdateSampleRate(): the filters start at 400 Hz and are resynthesized when the
+// interval averaged over about one second drifts by more than 1%
+struct RateTracker {
+    double step_s = 0.0025;
+    uint64_t last_us = 0;
+    double sum_s = 0;
+    int count = 0;
+    unsigned dropped = 0;
+
+    // Interval to the previous sample, 0 after a gap; sets retune_hz to a new rate if it drifted
+    double update(uint64_t timestamp_sample, double filter_rate_hz, double& retune_hz) {
+        const uint64_t last = last_us;
+        last_us = timestamp_sample;
+        retune_hz = 0;
+        if (last == 0 || timestamp_sample <= last) return 0;
+
+        const double dt_s = static_cast<float>((timestamp_sample - last) * 1e-6f);
+        if (dt_s > 1.5 * step_s) dropped += static_cast<unsigned>(std::lround(dt_s / step_s)) - 1;
+        if (dt_s > 10 * step_s) {
+            sum_s = 0;
+            count = 0;
+            return 0;
+        }
+
+        sum_s += dt_s;
+        count++;
+        if (sum_s >= 1) {
+            const double rate_hz = count / sum_s;
+            step_s = sum_s / count;
+            if (std::fabs(rate_hz - filter_rate_hz) > 0.01 * filter_rate_hz) retune_hz = rate_hz;
+            sum_s = 0;
+            count = 0;
+        }
+        return dt_s;
+    }
+};
+
+// One log decoded into rows of ImuFilterCore<>::LANES floats, an angular velocity sample each with
+// the latest acceleration, as the module steps. Duplicates are dropped, and a gap starts a new run,
+// as does the first acceleration sample, where the module warm-starts the filters again.
+struct ImuRecording {
+    static constexpr int LANES = ImuFilterCore<>::LANES;
+
+    std::string path;
+    std::vector<float> rows;
+    std::vector<std::size_t> runs; // first row of each run, where the filters warm-start
+    double rate_hz = 0; // mean sample rate within the runs
+    bool has_accel = false;
+
+    std::size_t size() const { return rows.size() / LANES; }
+
+    bool load(const char* file, int instance, std::string& error) {
+        ulog::ULogReader reader;
+        if (!reader.open(file, error)) return false;
+        path = file;
+        rows.clear();
+        runs.clear();
+        has_accel = false;
+
+        ImuLayout gyro_layout, accel_layout;
+        RateTracker rate;
+        float row[LANES] {};
+        double sum_s = 0;
+        std::size_t intervals = 0;
+        bool restart = false; // the first acceleration sample restarts the filters, as in PollTopics()
+        ulog::Message m;
+        while (reader.next(m)) {
+            if (m.type == 'A') {
+                if (gyro_layout.id < 0) {
+                    const int id = reader.subscription("vehicle_angular_velocity", instance);
+                    if (id >= 0 && !gyro_layout.resolve(reader, "vehicle_angular_velocity", id)) {
+                        error = "unexpected vehicle_angular_velocity format";
+                        return false;
+                    }
+                }
+                if (accel_layout.id < 0) {
+                    const int id = reader.subscription("vehicle_acceleration", instance);
+                    if (id >= 0 && !accel_layout.resolve(reader, "vehicle_acceleration", id)) {
+                        error = "unexpected vehicle_acceleration format";
+                        return false;
+                    }
+                }
+                continue;
+            }
+
+            if (m.type != 'D' || m.size < 2) continue;
+            uint16_t id;
+            std::memcpy(&id, m.data, sizeof(id));
+            const uint8_t* payload = m.data + 2;
+
+            if (id == accel_layout.id && m.size >= 2 + accel_layout.size) {
+                std::memcpy(row + ImuFilterCore<>::ACCEL, payload + accel_layout.xyz, 3 * sizeof(float));
+                restart = restart || !has_accel;
+                has_accel = true;
+                continue;
+            }
+            if (id != gyro_layout.id || m.size < 2 + gyro_layout.size) continue;
+
+            uint64_t timestamp_sample;
+            std::memcpy(&timestamp_sample, payload + gyro_layout.timestamp_sample, sizeof(timestamp_sample));
+            if (rate.last_us != 0 && timestamp_sample <= rate.last_us) continue;
+
+            double retune_hz;
+            const double dt_s = rate.update(timestamp_sample, 1 / rate.step_s, retune_hz);
+            if (dt_s > 0) {
+                sum_s += dt_s;
+                intervals++;
+            }
+            if (!(dt_s > 0) || restart) runs.push_back(size());
+            restart = false;
+            std::memcpy(row + ImuFilterCore<>::GYRO, payload + gyro_layout.xyz, 3 * sizeof(float));
+            rows.insert(rows.end(), row, row + LANES);
+        }
+
+        if (gyro_layout.id < 0) {
+            error = "no vehicle_angular_velocity instance " + std::to_string(instance) + " in the log";
+            return false;
+        }
+        if (intervals == 0) {
+            error = "fewer than two angular velocity samples";
+            return false;
+        }
+        rate_hz = intervals / sum_s;
+        return true;
+    }
+};
@@ -0,0 +1,350 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Minimal PX4 ULog (https://docs.px4.io/main/en/dev_log/ulog_file_format.html) reading and writing
+// for the host tools.
+//
+// ULogReader maps the file and walks it one message at a time. Messages are views into the
+// mapping, nothing is copied and nothing is read ahead, and pages behind the cursor are released
+// every RELEASE_BYTES, so the resident memory stays bounded whatever the size of the log. Formats
+// are parsed into field offsets, so that a field of a logged topic is read with one memcpy from
+// its message.
+//
+// ULogWriter writes a log of a few topics: header, formats, subscriptions and data, through a
+// buffered stream.
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ulog {
+
+constexpr uint8_t MAGIC[7] {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
+constexpr std::size_t HEADER_SIZE = 16; // magic, version, start time
+constexpr std::size_t MESSAGE_HEADER_SIZE = 3; // uint16 size, uint8 type
+
+// Size of a basic field type, 0 for a nested format
+inline std::size_t basic_size(const std::string& type)
+{
+    static const std::map<std::string, std::size_t> sizes {
+        {"int8_t", 1}, {"uint8_t", 1}, {"bool", 1}, {"char", 1}, {"int16_t", 2}, {"uint16_t", 2},
+        {"int32_t", 4}, {"uint32_t", 4}, {"float", 4}, {"int64_t", 8}, {"uint64_t", 8}, {"double", 8},
+    };
+    const auto it = sizes.find(type);
+    return it != sizes.end() ? it->second : 0;
+}
+
+struct Field {
+    std::string type; // element type, e.g. float
+    std::string name;
+    int count = 1; // array length, 1 if not an array
+    std::size_t offset = 0; // in the serialized message
+};
+
+struct Format {
+    std::string name;
+    std::vector<Field> fields;
+    std::size_t size = 0; // serialized size, 0 until resolved
+
+    const Field* field(const std::string& name) const {
+        for (const Field& f : fields) {
+            if (f.name == name) return &f;
+        }
+        return nullptr;
+    }
+};
+
+struct Message {
+    uint8_t type = 0; // 'F', 'A', 'D', 'P', ...
+    const uint8_t* data = nullptr; // payload, inside the mapping
+    std::size_t size = 0;
+};
+
+class ULogReader {
+public:
+    static constexpr std::size_t RELEASE_BYTES = std::size_t(16) << 20;
+
+    ULogReader() = default;
+    ULogReader(const ULogReader&) = delete;
+    ULogReader& operator=(const ULogReader&) = delete;
+    ~ULogReader() { close(); }
+
+    // Maps path and checks its header and flags. On failure, error says why.
+    bool open(const char* path, std::string& error) {
+        close();
+        const int fd = ::open(path, O_RDONLY);
+        struct stat st {};
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            error = std::string("cannot open ") + path;
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        size_ = static_cast<std::size_t>(st.st_size);
+        void* map = size_ > 0 ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        ::close(fd); // the mapping stays valid
+        if (map == MAP_FAILED) {
+            error = std::string("cannot map ") + path;
+            size_ = 0;
+            return false;
+        }
+        base_ = static_cast<const uint8_t*>(map);
+        madvise(const_cast<uint8_t*>(base_), size_, MADV_SEQUENTIAL);
+
+        if (size_ < HEADER_SIZE || std::memcmp(base_, MAGIC, sizeof(MAGIC)) != 0) {
+            error = "not a ULog file";
+            return false;
+        }
+        std::memcpy(&start_us_, base_ + 8, sizeof(start_us_));
+        cursor_ = HEADER_SIZE;
+
+        // the flag bits message, if present, comes first; unknown incompatible flags mean the
+        // layout cannot be read, data appended after a crash is read on from its offset
+        Message m;
+        if (peek(m) && m.type == 'B' && m.size >= 40) {
+            const uint8_t* incompat = m.data + 8;
+            if ((incompat[0] & ~1u) != 0 || std::memcmp(incompat + 1, "\0\0\0\0\0\0\0", 7) != 0) {
+                error = "unsupported incompatible ULog flags";
+                return false;
+            }
+            std::memcpy(&appended_, m.data + 16, sizeof(appended_));
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_ != nullptr) munmap(const_cast<uint8_t*>(base_), size_);
+        base_ = nullptr;
+        size_ = cursor_ = released_ = 0;
+        appended_ = 0;
+        formats_.clear();
+        subscriptions_.clear();
+    }
+
+    // The next message, with the formats, subscriptions and truncation handled. Returns false at
+    // the end of the file or of its last complete message.
+    bool next(Message& m) {
+        if (appended_ != 0 && cursor_ >= appended_) appended_ = 0; // reached it without a cut
+        if (!peek(m)) {
+            // the message before appended data may have been cut off when the log was closed
+            if (appended_ == 0 || cursor_ >= appended_) return false;
+            cursor_ = static_cast<std::size_t>(appended_);
+            appended_ = 0;
+            if (!peek(m)) return false;
+        }
+        cursor_ += MESSAGE_HEADER_SIZE + m.size;
+
+        if (m.type == 'F') addFormat(m);
+        if (m.type == 'A' && m.size > 3) {
+            uint16_t id;
+            std::memcpy(&id, m.data + 1, sizeof(id));
+            subscriptions_[id] = {std::string(reinterpret_cast<const char*>(m.data + 3), m.size - 3), m.data[0]};
+        }
+
+        if (cursor_ - released_ >= RELEASE_BYTES) release();
+        return true;
+    }
+
+    // Message id of a subscription to topic instance multi_id, or -1 if it is not logged (yet)
+    int subscription(const char* topic, int multi_id = 0) const {
+        for (const auto& s : subscriptions_) {
+            if (s.second.topic == topic && s.second.multi_id == multi_id) return s.first;
+        }
+        return -1;
+    }
+
+    const Format* format(const std::string& name) { // Resolved format, nullptr if unknown
+        const auto it = formats_.find(name);
+        if (it == formats_.end() || !resolve(it->second, 0)) return nullptr;
+        return &it->second;
+    }
+
+    uint64_t startTime() const { return start_us_; } // Microseconds, from the header
+    std::size_t size() const { return size_; }
+    std::size_t position() const { return cursor_; }
+
+private:
+    struct Subscription {
+        std::string topic;
+        int multi_id;
+    };
+
+    bool peek(Message& m) const {
+        if (cursor_ + MESSAGE_HEADER_SIZE > size_) return false;
+        uint16_t size;
+        std::memcpy(&size, base_ + cursor_, sizeof(size));
+        if (cursor_ + MESSAGE_HEADER_SIZE + size > size_) return false;
+        if (appended_ != 0 && cursor_ < appended_ && cursor_ + MESSAGE_HEADER_SIZE + size > appended_) return false;
+        m.type = base_[cursor_ + 2];
+        m.data = base_ + cursor_ + MESSAGE_HEADER_SIZE;
+        m.size = size;
+        return true;
+    }
+
+    // "name:type field;type[n] field;..."
+    void addFormat(const Message& m) {
+        const std::string text(reinterpret_cast<const char*>(m.data), m.size);
+        const std::size_t colon = text.find(':');
+        if (colon == std::string::npos) return;
+        Format f;
+        f.name = text.substr(0, colon);
+        std::size_t start = colon + 1;
+        while (start < text.size()) {
+            std::size_t end = text.find(';', start);
+            if (end == std::string::npos) end = text.size();
+            const std::string decl = text.substr(start, end - start);
+            const std::size_t space = decl.find(' ');
+            if (space != std::string::npos) {
+                Field field;
+                field.type = decl.substr(0, space);
+                field.name = decl.substr(space + 1);
+                const std::size_t bracket = field.type.find('[');
+                if (bracket != std::string::npos) {
+                    field.count = std::atoi(field.type.c_str() + bracket + 1);
+                    field.type.erase(bracket);
+                }
+                f.fields.push_back(field);
+            }
+            start = end + 1;
+        }
+        formats_[f.name] = f;
+    }
+
+    // Field offsets and size of f, nested formats first; false if a type is missing
+    bool resolve(Format& f, int depth) {
+        if (f.size > 0) return true;
+        if (depth > 16) return false; // recursive formats
+        std::size_t offset = 0;
+        for (Field& field : f.fields) {
+            std::size_t size = basic_size(field.type);
+            if (size == 0) {
+                const auto it = formats_.find(field.type);
+                if (it == formats_.end() || !resolve(it->second, depth + 1)) return false;
+                size = it->second.size;
+            }
+            field.offset = offset;
+            offset += size * static_cast<std::size_t>(field.count);
+        }
+        f.size = offset;
+        return offset > 0;
+    }
+
+    void release() { // drop the pages already read from the resident set
+        const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t end = cursor_ / page * page;
+        if (end > released_) madvise(const_cast<uint8_t*>(base_) + released_, end - released_, MADV_DONTNEED);
+        released_ = end;
+    }
+
+    const uint8_t* base_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t cursor_ = 0;
+    std::size_t released_ = 0; // pages before this offset are released
+    uint64_t appended_ = 0; // offset of data appended after a crash, 0 if none
+    uint64_t start_us_ = 0;
+    std::map<std::string, Format> formats_;
+    std::map<uint16_t, Subscription> subscriptions_;
+};
+
+// Name and value of a parameter message, false if its type is neither int32_t nor float
+inline bool parameter(const Message& m, std::string& name, double& value)
+{
+    if (m.size < 1 || m.size < 1u + m.data[0]) return false;
+    const std::string key(reinterpret_cast<const char*>(m.data + 1), m.data[0]);
+    const std::size_t space = key.find(' ');
+    if (space == std::string::npos || m.size < 1u + m.data[0] + 4) return false;
+    const std::string type = key.substr(0, space);
+    const uint8_t* v = m.data + 1 + m.data[0];
+    if (type == "int32_t") {
+        int32_t i;
+        std::memcpy(&i, v, sizeof(i));
+        value = i;
+    } else if (type == "float") {
+        float f;
+        std::memcpy(&f, v, sizeof(f));
+        value = f;
+    } else {
+        return false;
+    }
+    name = key.substr(space + 1);
+    return true;
+}
+
+class ULogWriter {
+public:
+    ULogWriter() = default;
+    ULogWriter(const ULogWriter&) = delete;
+    ULogWriter& operator=(const ULogWriter&) = delete;
+    ~ULogWriter() { close(); }
+
+    bool open(const char* path, uint64_t start_us) {
+        file_ = std::fopen(path, "wb");
+        if (file_ == nullptr) return false;
+        std::fwrite(MAGIC, 1, sizeof(MAGIC), file_);
+        std::fputc(1, file_); // version
+        std::fwrite(&start_us, sizeof(start_us), 1, file_);
+        const uint8_t flags[40] {}; // no compatible or incompatible flags, nothing appended
+        write('B', flags, sizeof(flags));
+        return true;
+    }
+
+    bool close() {
+        if (file_ == nullptr) return true;
+        const bool ok = std::fclose(file_) == 0;
+        file_ = nullptr;
+        return ok;
+    }
+
+    void format(const char* definition) { write('F', definition, std::strlen(definition)); } // "name:type field;..."
+
+    void parameter(const char* name, int32_t value) { writeParameter("int32_t", name, &value, sizeof(value)); }
+    void parameter(const char* name, float value) { writeParameter("float", name, &value, sizeof(value)); }
+
+    uint16_t subscribe(const char* topic, uint8_t multi_id = 0) { // Returns the message id for data()
+        const uint16_t id = next_id_++;
+        std::vector<uint8_t> m(3 + std::strlen(topic));
+        m[0] = multi_id;
+        std::memcpy(&m[1], &id, sizeof(id));
+        std::memcpy(&m[3], topic, m.size() - 3);
+        write('A', m.data(), m.size());
+        return id;
+    }
+
+    void data(uint16_t id, const void* payload, std::size_t size) { // payload serialized as its format
+        const uint16_t length = static_cast<uint16_t>(size + sizeof(id));
+        std::fwrite(&length, sizeof(length), 1, file_);
+        std::fputc('D', file_);
+        std::fwrite(&id, sizeof(id), 1, file_);
+        std::fwrite(payload, 1, size, file_);
+    }
+
+private:
+    void writeParameter(const char* type, const char* name, const void* value, std::size_t size) {
+        const std::string key = std::string(type) + " " + name;
+        std::vector<uint8_t> m(1 + key.size() + size);
+        m[0] = static_cast<uint8_t>(key.size());
+        std::memcpy(&m[1], key.data(), key.size());
+        std::memcpy(&m[1 + key.size()], value, size);
+        write('P', m.data(), m.size());
+    }
+
+    void write(uint8_t type, const void* payload, std::size_t size) {
+        const uint16_t length = static_cast<uint16_t>(size);
+        std::fwrite(&length, sizeof(length), 1, file_);
+        std::fputc(type, file_);
+        std::fwrite(payload, 1, size, file_);
+    }
+
+    FILE* file_ = nullptr;
+    uint16_t next_id_ = 0;
+};
+
+} // namespace ulog
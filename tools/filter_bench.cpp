@@ -0,0 +1,415 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Host micro-benchmark of filter synthesis and of every filter realization in the repository root.
+// Each case is timed as the best of --repeat runs of at least --min-time seconds, and reported in
+// ns per sample and samples per second. One sample is one value of one signal, so a bank advancing
+// six lanes by one row processes six samples; for synthesis, one sample is one synthesized filter.
+//
+//     filter_bench                          table on stdout
+//     filter_bench --json > base.json       one JSON object per case and line, stable order
+//     filter_bench --compare base.json      exit with 1 if a case got slower than --threshold
+//     filter_bench --filter bank            only cases whose name contains "bank"
+
+#include "ButterworthBank.hpp"
+#include "ButterworthFilt.hpp"
+#include "ButterworthSynth.hpp"
+#include "DynamicNotch.hpp"
+#include "FilterDesign.hpp"
+#include "ImuFilterCore.hpp"
+#include "SpectrumMonitor.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    double min_time = 0.02; // seconds per timed run
+    int repeat = 5;
+    bool json = false;
+    const char* filter = nullptr;
+    const char* compare = nullptr;
+    double threshold = 0.10; // relative slowdown that fails --compare
+};
+
+struct Result {
+    std::string name; // unique key, e.g. sos.processBuffer/double/N4/B256
+    std::string benchmark;
+    const char* type;
+    int order;
+    int block; // samples per processBuffer call, 0 for per-sample process() and synthesis
+    int lanes;
+    double ns_per_sample;
+};
+
+constexpr double kFc = 40.0; // cutoff and rate of all benchmarked filters
+constexpr double kFs = 400.0;
+constexpr std::size_t kSignal = 4096; // samples per lane run through a filter per timed pass
+constexpr int kBlocks[] = {1, 16, 256, 4096};
+
+volatile double g_sink; // keeps the filtered output alive
+
+template <typename T> const char* type_name();
+template <> const char* type_name<float>() { return "float"; }
+template <> const char* type_name<double>() { return "double"; }
+
+template <typename T>
+std::vector<T> white_noise(std::size_t n)
+{
+    std::mt19937 rng(12345); // fixed seed, every run filters the same signal
+    std::normal_distribution<double> dist(0.0, 1.0);
+    std::vector<T> v(n);
+    for (T& x : v) x = static_cast<T>(dist(rng));
+    return v;
+}
+
+// Best time of one pass over samples_per_pass samples, in ns per sample
+template <typename F>
+double time_ns_per_sample(F&& pass, std::size_t samples_per_pass, const Options& opt)
+{
+    using clock = std::chrono::steady_clock;
+    const auto seconds = [](clock::duration d) { return std::chrono::duration<double>(d).count(); };
+
+    // grow the number of passes per run until one run lasts min_time
+    long passes = 1;
+    for (;;) {
+        const auto t0 = clock::now();
+        for (long i = 0; i < passes; ++i) pass();
+        if (seconds(clock::now() - t0) >= opt.min_time || passes >= (1L << 30)) break;
+        passes *= 2;
+    }
+
+    double best = 1e300;
+    for (int r = 0; r < opt.repeat; ++r) {
+        const auto t0 = clock::now();
+        for (long i = 0; i < passes; ++i) pass();
+        const double t = seconds(clock::now() - t0);
+        best = t < best ? t : best;
+    }
+    return best * 1e9 / (static_cast<double>(passes) * samples_per_pass);
+}
+
+class Runner {
+public:
+    explicit Runner(const Options& opt) : opt_(opt) {}
+
+    bool selected(const std::string& name) const {
+        return opt_.filter == nullptr || name.find(opt_.filter) != std::string::npos;
+    }
+
+    template <typename F>
+    void run(const std::string& benchmark, const char* type, int order, int block, int lanes,
+             std::size_t samples_per_pass, F&& pass) {
+        std::string name = benchmark + "/" + type + "/N" + std::to_string(order);
+        if (block > 0) name += "/B" + std::to_string(block);
+        if (lanes > 1) name += "/L" + std::to_string(lanes);
+        if (!selected(name)) return;
+
+        const double ns = time_ns_per_sample(pass, samples_per_pass, opt_);
+        results_.push_back({name, benchmark, type, order, block, lanes, ns});
+        if (!opt_.json) {
+            std::printf("%-40s %10.3f ns/sample %12.4g samples/s\n", name.c_str(), ns, 1e9 / ns);
+            std::fflush(stdout);
+        }
+    }
+
+    const std::vector<Result>& results() const { return results_; }
+
+private:
+    const Options& opt_;
+    std::vector<Result> results_;
+};
+
+template <typename T>
+void bench_synthesis(Runner& runner)
+{
+    for (int N = 1; N <= BUTTERWORTH_MAX_ORDER; ++N) {
+        runner.run("synth.butter_synth", type_name<T>(), N, 0, 1, 1, [N] {
+            g_sink = butter_synth<T>(N, kFc, kFs).b[0];
+        });
+        runner.run("synth.butter_synth_sos", type_name<T>(), N, 0, 1, 1, [N] {
+            g_sink = butter_synth_sos<T>(N, kFc, kFs).s[0].b[0];
+        });
+        // the other families, a cache miss when tuning them live
+        for (int f = 1; f < FILTER_FAMILIES; ++f) {
+            const FilterFamily family = filter_family(f);
+            const std::string name = std::string("synth.filter_synth_sos.") + filter_family_name(family);
+            runner.run(name.c_str(), type_name<T>(), N, 0, 1, 1, [family, N] {
+                g_sink = filter_synth_sos<T>(family, N, kFc, kFs).s[0].b[0];
+            });
+        }
+    }
+}
+
+// ButterworthIIRT (whole polynomial) and ButterworthSOST (sections) share the same interface
+template <typename T, typename Filter>
+void bench_single(Runner& runner, const char* realization, Filter (*make)(int))
+{
+    const std::vector<T> in = white_noise<T>(kSignal);
+    std::vector<T> out(kSignal);
+
+    for (int N = 1; N <= BUTTERWORTH_MAX_ORDER; ++N) {
+        Filter f = make(N);
+        runner.run(std::string(realization) + ".process", type_name<T>(), N, 0, 1, kSignal, [&] {
+            T acc = 0;
+            for (std::size_t i = 0; i < kSignal; ++i) acc += f.process(in[i]);
+            g_sink = acc;
+        });
+
+        for (int block : kBlocks) {
+            runner.run(std::string(realization) + ".processBuffer", type_name<T>(), N, block, 1, kSignal, [&] {
+                for (std::size_t i = 0; i < kSignal; i += block) f.processBuffer(&in[i], &out[i], block);
+                g_sink = out[kSignal - 1];
+            });
+        }
+    }
+}
+
+template <typename T>
+ButterworthIIRT<T> make_iir(int N) { return ButterworthIIRT<T>(butter_synth<T>(N, kFc, kFs)); }
+
+template <typename T>
+ButterworthSOST<T> make_sos(int N) { return ButterworthSOST<T>(butter_synth_sos<T>(N, kFc, kFs)); }
+
+// Lanes axes filtered by one ButterworthIIRBank, against one ButterworthSOST per axis on the same
+// row-major data. Block 1 is the per-sample vehicle topic path, 32 a sensor FIFO batch.
+template <std::size_t Lanes, typename T>
+void bench_axes(Runner& runner)
+{
+    const std::vector<T> in = white_noise<T>(kSignal * Lanes);
+    std::vector<T> out(kSignal * Lanes);
+
+    for (int N = 1; N <= BUTTERWORTH_MAX_ORDER; ++N) {
+        const IIR_SOST<T> sos = butter_synth_sos<T>(N, kFc, kFs);
+
+        for (int block : {1, 32, 4096}) {
+            ButterworthIIRBank<Lanes, T> bank(sos);
+            runner.run("bank.processBuffer", type_name<T>(), N, block, Lanes, kSignal * Lanes, [&] {
+                for (std::size_t i = 0; i < kSignal; i += block) {
+                    bank.processBuffer(&in[i * Lanes], &out[i * Lanes], block);
+                }
+                g_sink = out[kSignal * Lanes - 1];
+            });
+
+            ButterworthSOST<T> axes[Lanes];
+            for (auto& f : axes) f.setCoeffs(sos);
+            runner.run("sos.axes", type_name<T>(), N, block, Lanes, kSignal * Lanes, [&] {
+                for (std::size_t i = 0; i < kSignal; i += block) {
+                    for (std::size_t t = i; t < i + block; ++t) {
+                        for (std::size_t l = 0; l < Lanes; ++l) out[t * Lanes + l] = axes[l].process(in[t * Lanes + l]);
+                    }
+                }
+                g_sink = out[kSignal * Lanes - 1];
+            });
+        }
+    }
+}
+
+// Dynamic notches on the six lanes of ImuFilterCore, estimator included, N being the number of
+// notches per lane
+template <typename T>
+void bench_notch(Runner& runner)
+{
+    constexpr std::size_t Lanes = 6;
+    const std::vector<T> in = white_noise<T>(kSignal * Lanes);
+    std::vector<T> out(kSignal * Lanes);
+    const bool enabled[2] {true, true};
+
+    for (int N = 1; N <= DynamicNotch<Lanes, T>::MAX_NOTCHES; ++N) {
+        for (int block : {1, 32}) {
+            DynamicNotch<Lanes, T> notch;
+            notch.configure(N, enabled, 80, 180, 20, kFs);
+            runner.run("notch.processBuffer", type_name<T>(), N, block, Lanes, kSignal * Lanes, [&] {
+                std::memcpy(out.data(), in.data(), out.size() * sizeof(T));
+                for (std::size_t i = 0; i < kSignal; i += block) notch.processBuffer(&out[i * Lanes], block);
+                g_sink = out[kSignal * Lanes - 1];
+            });
+        }
+    }
+}
+
+// Spectrum monitor on six lanes, input and output side, N being the frames per report
+template <typename T>
+void bench_spectrum(Runner& runner)
+{
+    constexpr std::size_t Lanes = 6;
+    const std::vector<T> in = white_noise<T>(kSignal * Lanes);
+    const double noise_hz[2] {kFc, kFc};
+
+    for (int N : {1, 8}) {
+        for (int block : {1, 32}) {
+            SpectrumMonitor<Lanes> spectrum;
+            spectrum.configure(kFs, N, noise_hz);
+            runner.run("spectrum.push", type_name<T>(), N, block, Lanes, kSignal * Lanes, [&] {
+                for (std::size_t i = 0; i < kSignal; i += block) {
+                    spectrum.pushInput(&in[i * Lanes], block);
+                    spectrum.pushOutput(&in[i * Lanes], block);
+                }
+                g_sink = spectrum.report().noise_out[0];
+            });
+        }
+    }
+}
+
+// ImuFilterCore::step() on Imus IMUs, in one core with all their lanes against one core per IMU,
+// N being the order of all four filters
+template <std::size_t Imus, typename T>
+void bench_imus(Runner& runner)
+{
+    using Multi = ImuFilterCore<T, Imus>;
+    using Single = ImuFilterCore<T>;
+    constexpr std::size_t Lanes = Multi::LANES;
+    const std::vector<T> in = white_noise<T>(kSignal * Lanes);
+    std::vector<T> out(kSignal * Lanes), derivative(kSignal * Lanes);
+    const T dt_s = static_cast<T>(1 / kFs);
+
+    for (int N : {2, 4}) {
+        ImuFilterConfig config;
+        config.gyro_order = config.angacc_order = config.accel_order = config.jerk_order = N;
+        config.gyro_cutoff_hz = config.angacc_cutoff_hz = config.accel_cutoff_hz = config.jerk_cutoff_hz = kFc;
+
+        Multi multi;
+        multi.configure(config, kFs);
+        runner.run("core.step", type_name<T>(), N, 1, static_cast<int>(Lanes), kSignal * Lanes, [&] {
+            for (std::size_t i = 0; i < kSignal; ++i) multi.step(&in[i * Lanes], dt_s, &out[i * Lanes], &derivative[i * Lanes]);
+            g_sink = out[kSignal * Lanes - 1];
+        });
+
+        Single single[Imus];
+        for (Single& core : single) core.configure(config, kFs);
+        runner.run("core.step.per_imu", type_name<T>(), N, 1, static_cast<int>(Lanes), kSignal * Lanes, [&] {
+            for (std::size_t i = 0; i < kSignal; ++i) {
+                for (std::size_t k = 0; k < Imus; ++k) {
+                    const std::size_t row = i * Lanes + k * Single::LANES;
+                    single[k].step(&in[row], dt_s, &out[row], &derivative[row]);
+                }
+            }
+            g_sink = out[kSignal * Lanes - 1];
+        });
+    }
+}
+
+template <typename T>
+void bench_type(Runner& runner)
+{
+    bench_synthesis<T>(runner);
+    bench_single<T>(runner, "iir", make_iir<T>);
+    bench_single<T>(runner, "sos", make_sos<T>);
+    bench_axes<3, T>(runner);
+    bench_axes<6, T>(runner);
+    bench_notch<T>(runner);
+    bench_spectrum<T>(runner);
+    bench_imus<3, T>(runner);
+}
+
+void print_json(const std::vector<Result>& results)
+{
+    std::printf("[\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::printf("{\"name\": \"%s\", \"benchmark\": \"%s\", \"type\": \"%s\", \"order\": %d, \"block\": %d, "
+                    "\"lanes\": %d, \"ns_per_sample\": %.4f, \"samples_per_s\": %.6g}%s\n",
+                    r.name.c_str(), r.benchmark.c_str(), r.type, r.order, r.block, r.lanes,
+                    r.ns_per_sample, 1e9 / r.ns_per_sample, i + 1 < results.size() ? "," : "");
+    }
+    std::printf("]\n");
+}
+
+// Reads the name and ns_per_sample of every line written by print_json()
+bool load_baseline(const char* path, std::map<std::string, double>& baseline)
+{
+    FILE* f = std::fopen(path, "r");
+    if (f == nullptr) return false;
+
+    char line[1024];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        const char* name = std::strstr(line, "\"name\": \"");
+        const char* ns = std::strstr(line, "\"ns_per_sample\": ");
+        if (name == nullptr || ns == nullptr) continue;
+        name += std::strlen("\"name\": \"");
+        const char* end = std::strchr(name, '"');
+        if (end == nullptr) continue;
+        baseline[std::string(name, end)] = std::atof(ns + std::strlen("\"ns_per_sample\": "));
+    }
+    std::fclose(f);
+    return true;
+}
+
+// Lists every case slower than the baseline by more than the threshold, returns the number of them
+int compare(const std::vector<Result>& results, const std::map<std::string, double>& baseline, double threshold)
+{
+    int regressions = 0;
+    for (const Result& r : results) {
+        const auto it = baseline.find(r.name);
+        if (it == baseline.end() || !(it->second > 0)) continue;
+        const double change = r.ns_per_sample / it->second - 1;
+        if (change > threshold) {
+            std::fprintf(stderr, "regression %-40s %10.3f -> %10.3f ns/sample (%+.1f%%)\n",
+                         r.name.c_str(), it->second, r.ns_per_sample, 100 * change);
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+int usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--json] [--filter SUBSTRING] [--min-time SECONDS] [--repeat N]\n"
+                 "          [--compare BASELINE.json [--threshold FRACTION]]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--json") == 0) {
+            opt.json = true;
+        } else if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+            opt.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && has_value) {
+            opt.min_time = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && has_value) {
+            opt.repeat = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--compare") == 0 && has_value) {
+            opt.compare = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && has_value) {
+            opt.threshold = std::atof(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (opt.repeat < 1 || !(opt.min_time > 0)) return usage(argv[0]);
+
+    std::map<std::string, double> baseline;
+    if (opt.compare != nullptr && !load_baseline(opt.compare, baseline)) {
+        std::fprintf(stderr, "cannot read %s\n", opt.compare);
+        return 2;
+    }
+
+    Runner runner(opt);
+    bench_type<double>(runner);
+    bench_type<float>(runner);
+
+    if (opt.json) print_json(runner.results());
+
+    if (opt.compare != nullptr) {
+        const int regressions = compare(runner.results(), baseline, opt.threshold);
+        if (regressions > 0) {
+            std::fprintf(stderr, "%d of %zu cases slower than %s by more than %.0f%%\n",
+                         regressions, runner.results().size(), opt.compare, 100 * opt.threshold);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,360 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Self-checks of the filter code the module does not run, so imu_sim's reference check does not
+// cover it: the order-specialized filters and constexpr synthesis of ButterworthStatic.hpp, and
+// the fixed-point cascades of ButterworthFixed.hpp against their stated accuracy. It also checks
+// the hits, misses and evictions of CoeffCache, which imu_sim only sees through its results, the
+// normalization FilterDesign.hpp promises for every family and order, and that the dynamic
+// notches stay finite on degenerate input. Last, it reads back a log written by ULogWriter with
+// ULogReader (ULog.hpp), including data appended after a cut message. Every check prints pass or
+// FAIL with its worst deviation, and the exit status is non-zero if one fails.
+//
+//     filter_check
+
+#include "ButterworthFilt.hpp"
+#include "ButterworthFixed.hpp"
+#include "ButterworthStatic.hpp"
+#include "CoeffCache.hpp"
+#include "DynamicNotch.hpp"
+#include "FilterDesign.hpp"
+#include "FilterResponse.hpp"
+#include "ULog.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// Worst deviation of one check against its tolerance
+struct Check {
+    const char* name;
+    double tolerance;
+    double max_error = 0;
+
+    void add(double value, double reference) {
+        const double e = std::fabs(value - reference);
+        max_error = e > max_error || std::isnan(e) ? e : max_error; // a NaN fails the check
+    }
+
+    void addRelative(double value, double reference) { // relative to the size of reference, absolute below 1
+        const double scale = 1 + std::fabs(reference);
+        add(value / scale, reference / scale);
+    }
+
+    bool report() const {
+        const bool pass = max_error <= tolerance;
+        std::printf("%s check: %s, max deviation %.3g (tolerance %.3g)\n", name, pass ? "pass" : "FAIL", max_error,
+                    tolerance);
+        return pass;
+    }
+};
+
+constexpr double FS = 400;
+constexpr double RATIOS[] = {0.25, 0.1, 0.02}; // fc / fs, down to the lowest cutoff ButterworthFixed.hpp states
+
+// Coefficients in constant expressions, as a fixed airframe configuration bakes them into flash
+constexpr IIR_SOS BAKED_SOS = butter_synth_sos<4>(30.0, 400.0);
+static_assert(BAKED_SOS.sections == 2 && BAKED_SOS.order == 4, "constexpr synthesis");
+
+// Half-scale white noise, the input of every filter check
+std::vector<double> half_scale_noise(std::size_t n)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> u(-0.5, 0.5);
+    std::vector<double> x(n);
+    for (double& v : x) v = u(rng);
+    return x;
+}
+
+// butter_synth_sos<N>() and butter_synth<N>() against the runtime synthesis, and
+// ButterworthIIRStatic<N> against ButterworthIIR on the same coefficients
+template <int N>
+void check_static(const std::vector<double>& x, Check& sos, Check& direct, Check& filter)
+{
+    for (double ratio : RATIOS) {
+        const double fc = ratio * FS;
+        const IIR_SOS s = butter_synth_sos<N>(fc, FS), s_ref = butter_synth_sos(N, fc, FS);
+        sos.add(s.sections, s_ref.sections);
+        for (int i = 0; i < s_ref.sections; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                sos.addRelative(s.s[i].b[k], s_ref.s[i].b[k]);
+                sos.addRelative(s.s[i].a[k], s_ref.s[i].a[k]);
+            }
+        }
+
+        const IIR_Coeffs c = butter_synth<N>(fc, FS), c_ref = butter_synth(N, fc, FS);
+        for (int k = 0; k <= N; ++k) {
+            direct.addRelative(c.b[k], c_ref.b[k]);
+            direct.addRelative(c.a[k], c_ref.a[k]);
+        }
+
+        ButterworthIIRStatic<N> f(c_ref);
+        ButterworthIIR f_ref(c_ref);
+        for (double v : x) filter.add(f.process(v), f_ref.process(v));
+    }
+    check_static<N + 1>(x, sos, direct, filter);
+}
+
+template <>
+void check_static<BUTTERWORTH_MAX_ORDER + 1>(const std::vector<double>&, Check&, Check&, Check&) {}
+
+// FixedPointSOS<Q> against the double cascade on the same quantized input, in full-scale units
+template <typename Q>
+void check_fixed(const std::vector<double>& x, Check& check)
+{
+    const double scale = std::ldexp(1.0, butterworth_fixed::Format<Q>::bits - 1);
+    for (int order = 1; order <= BUTTERWORTH_MAX_ORDER; ++order) {
+        for (double ratio : RATIOS) {
+            const IIR_SOS c = butter_synth_sos(order, ratio * FS, FS);
+            FixedPointSOS<Q> f(c);
+            ButterworthSOS f_ref(c);
+            for (double v : x) {
+                const Q q = butterworth_fixed::saturate<Q>(std::llround(v * scale));
+                check.add(f.process(q) / scale, f_ref.process(q / scale));
+            }
+        }
+    }
+}
+
+// CoeffCache<double, 4> over requests that fill it and then evict the least recently used entry:
+// every lookup against the hit or miss expected, and its sections against a synthesis at the
+// quantized cutoff and rate
+void check_cache(Check& check)
+{
+    struct Request {
+        FilterFamily family;
+        int order;
+        double fc, fs;
+        bool hit;
+    };
+    const FilterFamily B = FilterFamily::butterworth;
+    const Request requests[] = {
+        {B, 2, 30, 400, false}, {B, 2, 30, 400, true}, {B, 4, 30, 400, false}, {B, 2, 60, 400, false},
+        {B, 4, 60, 400, false}, // full
+        {B, 2, 30.004, 400.2, true}, // the same keys as the first request, now the most recent entry
+        {B, 6, 30, 400, false}, // evicts 4:30, the least recently used
+        {B, 4, 30, 400, false}, // evicts 2:60
+        {B, 2, 60, 400, false}, // evicts 4:60
+        {B, 2, 30, 400, true}, {B, 6, 30, 400, true},
+        {FilterFamily::bessel, 2, 30, 400, false}, // the family is part of the key
+    };
+
+    CoeffCache<double, 4> cache(0.01, 1.0);
+    for (const Request& r : requests) {
+        const uint32_t hits = cache.hits(), misses = cache.misses();
+        const IIR_SOS& c = cache.get(r.family, r.order, r.fc, r.fs);
+        check.add(cache.hits() - hits, r.hit ? 1 : 0);
+        check.add(cache.misses() - misses, r.hit ? 0 : 1);
+
+        const IIR_SOS ref = filter_synth_sos(r.family, r.order, std::llround(r.fc / 0.01) * 0.01, std::llround(r.fs));
+        check.add(c.sections, ref.sections);
+        for (int i = 0; i < ref.sections; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                check.add(c.s[i].b[k], ref.s[i].b[k]);
+                check.add(c.s[i].a[k], ref.s[i].a[k]);
+            }
+        }
+    }
+}
+
+// Every family of FilterDesign.hpp at orders 1-10: unity gain at DC of every section and of the
+// cascade from filter_synth_sos(), and -3 dB at the cutoff
+void check_design(Check& dc, Check& cutoff)
+{
+    const double half_power_db = -10 * std::log10(2.0);
+    for (int f = 0; f < FILTER_FAMILIES; ++f) {
+        for (int order = 1; order <= BUTTERWORTH_MAX_ORDER; ++order) {
+            for (double ratio : RATIOS) {
+                const IIR_SOS c = filter_synth_sos(filter_family(f), order, ratio * FS, FS);
+                for (int i = 0; i < c.sections; ++i) {
+                    const IIR_Biquad& s = c.s[i];
+                    dc.add((s.b[0] + s.b[1] + s.b[2]) / (s.a[0] + s.a[1] + s.a[2]), 1);
+                }
+                ResponseChain chain(FS);
+                chain.add(c);
+                dc.add(std::abs(chain.freqz(0)), 1);
+                cutoff.add(20 * std::log10(std::abs(chain.freqz(ratio * FS))), half_power_db);
+            }
+        }
+    }
+}
+
+// DynamicNotch on inputs that leave bins of the peak estimator at zero or rounding-negative power:
+// zero, constant, vibration tones small enough that the power of some bins underflows, and a
+// quantized tone. Every peak, notch centre and output must stay finite.
+void check_notch(Check& check)
+{
+    constexpr std::size_t LANES = 6, ROWS = 4 * PeakEstimator::WINDOW;
+    const bool enabled[DynamicNotch<LANES>::GROUPS] {true, true};
+    const int TONES = 16; // amplitudes 1e-26 to 1e-22
+    for (int kind = 0; kind < TONES + 3; ++kind) {
+        DynamicNotch<LANES> notch;
+        notch.configure(2, enabled, 80, 180, 20, FS);
+        double x[LANES];
+        for (std::size_t t = 0; t < ROWS; ++t) {
+            for (std::size_t l = 0; l < LANES; ++l) {
+                const double tone = std::sin(2 * M_PI * 156.5625 * t / FS + l);
+                x[l] = kind == TONES ? 0.0
+                       : kind == TONES + 1 ? 1.0
+                       : kind == TONES + 2 ? std::round(4 * tone) + 1
+                       : std::pow(10.0, -26 + 0.25 * kind) * tone;
+            }
+            notch.processBuffer(x, 1);
+            for (double v : x) check.add(std::isfinite(v), true);
+        }
+        for (int i = 0; i < notch.estimator().peaks(); ++i) check.add(std::isfinite(notch.estimator().peak(i)), true);
+        for (int i = 0; i < notch.count(); ++i) check.add(std::isfinite(notch.center(i)), true);
+    }
+}
+
+// A log from ULogWriter with a format, two parameters and two instances of a topic, then a message
+// cut off and data appended behind it as PX4 does after a crash, read back with ULogReader: every
+// value against what was written, and a log with an unknown incompatible flag must be rejected
+void check_ulog(Check& check)
+{
+    char path[] = "/tmp/filter_check_XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        check.add(1, 0);
+        return;
+    }
+    ::close(fd);
+
+    // uint64 timestamp, uint32 device_id, float[3] xyz
+    const auto sample = [](int i, uint8_t buffer[24]) {
+        const uint64_t timestamp = 1000 * static_cast<uint64_t>(i);
+        const uint32_t device_id = 100 + i % 2;
+        const float xyz[3] {0.5f * i, -1.0f * i, 0.25f};
+        std::memcpy(buffer, &timestamp, 8);
+        std::memcpy(buffer + 8, &device_id, 4);
+        std::memcpy(buffer + 12, xyz, sizeof(xyz));
+    };
+    constexpr int WRITTEN = 100, APPENDED = 10;
+    uint8_t buffer[24];
+
+    ulog::ULogWriter writer;
+    check.add(writer.open(path, 123456789), true);
+    writer.format("sample:uint64_t timestamp;uint32_t device_id;float[3] xyz;");
+    writer.parameter("SFILT_GYRO_N", static_cast<int32_t>(4));
+    writer.parameter("SFILT_GYRO_FREQ", 30.5f);
+    const uint16_t ids[2] {writer.subscribe("sample"), writer.subscribe("sample", 1)};
+    for (int i = 0; i < WRITTEN; ++i) {
+        sample(i, buffer);
+        writer.data(ids[i % 2], buffer, sizeof(buffer));
+    }
+    check.add(writer.close(), true);
+
+    // a data message cut after its first bytes, the appended data behind it, and the flag message
+    // pointing there with the DATA_APPENDED incompatible flag
+    FILE* f = std::fopen(path, "r+b");
+    std::fseek(f, 0, SEEK_END);
+    const uint8_t cut[5] {2 + sizeof(buffer), 0, 'D', 0, 0};
+    std::fwrite(cut, 1, sizeof(cut), f);
+    const uint64_t appended = static_cast<uint64_t>(std::ftell(f));
+    for (int i = WRITTEN; i < WRITTEN + APPENDED; ++i) {
+        const uint16_t length = 2 + sizeof(buffer);
+        sample(i, buffer);
+        std::fwrite(&length, 2, 1, f);
+        std::fputc('D', f);
+        std::fwrite(&ids[i % 2], 2, 1, f);
+        std::fwrite(buffer, 1, sizeof(buffer), f);
+    }
+    const long flags = ulog::HEADER_SIZE + ulog::MESSAGE_HEADER_SIZE; // compat[8], incompat[8], appended[3]
+    const uint8_t incompat = 1;
+    std::fseek(f, flags + 8, SEEK_SET);
+    std::fwrite(&incompat, 1, 1, f);
+    std::fseek(f, flags + 16, SEEK_SET);
+    std::fwrite(&appended, sizeof(appended), 1, f);
+    std::fclose(f);
+
+    ulog::ULogReader reader;
+    std::string error;
+    check.add(reader.open(path, error), true);
+    check.add(static_cast<double>(reader.startTime()), 123456789);
+    ulog::Message m;
+    int params = 0, data = 0;
+    while (reader.next(m)) {
+        std::string name;
+        double value;
+        if (m.type == 'P' && ulog::parameter(m, name, value)) {
+            check.add(value, name == "SFILT_GYRO_N" ? 4 : 30.5);
+            params++;
+        }
+        if (m.type != 'D') continue;
+        uint16_t id;
+        std::memcpy(&id, m.data, sizeof(id));
+        check.add(id, reader.subscription("sample", data % 2));
+        sample(data++, buffer);
+        check.add(m.size == 2 + sizeof(buffer) && std::memcmp(m.data + 2, buffer, sizeof(buffer)) == 0, true);
+    }
+    check.add(params, 2);
+    check.add(data, WRITTEN + APPENDED);
+
+    const ulog::Format* format = reader.format("sample");
+    check.add(format != nullptr, true);
+    if (format != nullptr) {
+        const ulog::Field* xyz = format->field("xyz");
+        check.add(static_cast<double>(format->size), 24);
+        check.add(xyz != nullptr && xyz->type == "float" && xyz->count == 3 && xyz->offset == 12, true);
+    }
+
+    f = std::fopen(path, "r+b");
+    const uint8_t unknown = 2;
+    std::fseek(f, flags + 8, SEEK_SET);
+    std::fwrite(&unknown, 1, 1, f);
+    std::fclose(f);
+    check.add(reader.open(path, error), false);
+    reader.close();
+    std::remove(path);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 1) {
+        std::fprintf(stderr, "usage: %s\n", argv[0]);
+        return 2;
+    }
+    const std::vector<double> x = half_scale_noise(20000);
+    bool ok = true;
+
+    Check sos{"constexpr butter_synth_sos", 1e-12}, direct{"constexpr butter_synth", 1e-12},
+        filter{"ButterworthIIRStatic", 1e-12};
+    check_static<1>(x, sos, direct, filter);
+    ok = sos.report() && ok;
+    ok = direct.report() && ok;
+    ok = filter.report() && ok;
+
+    // the accuracy stated in ButterworthFixed.hpp
+    Check q31{"FixedPointSOS<q31_t>", 5e-8}, q15{"FixedPointSOS<q15_t>", 3e-3};
+    check_fixed<q31_t>(x, q31);
+    check_fixed<q15_t>(x, q15);
+    ok = q31.report() && ok;
+    ok = q15.report() && ok;
+
+    Check cache{"CoeffCache", 0};
+    check_cache(cache);
+    ok = cache.report() && ok;
+
+    Check dc{"filter_synth_sos DC gain", 1e-12}, cutoff{"filter_synth_sos gain at cutoff [dB]", 1e-9};
+    check_design(dc, cutoff);
+    ok = dc.report() && ok;
+    ok = cutoff.report() && ok;
+
+    Check notch{"DynamicNotch finite on degenerate input", 0};
+    check_notch(notch);
+    ok = notch.report() && ok;
+
+    Check log{"ULog round trip", 0};
+    check_ulog(log);
+    ok = log.report() && ok;
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,297 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Frequency response of the four imu_filtering filters and of the two derivative chains, angular
+// rate -> backward difference -> angular acceleration filter, and acceleration -> difference ->
+// jerk filter, for a given sample rate and set of orders and cutoffs. The chains are shown
+// relative to an ideal differentiator, so their gain is 0 dB and their phase 0 deg in the
+// passband, and the phase is the lag the filtering adds to the derivative.
+//
+//     filter_response --fs 400 --gyro 2:30 --angacc 2:30 --at 20
+//     filter_response --fs 400 --gyro 2:188.5 --rad --table angacc_chain
+//     filter_response --fs 1000 --gyro 8:15 --direct --float      pole radius of a float polynomial
+//     filter_response --fs 400 --gyro 2:30 --fused angacc          derivative from the gyro filter
+//     filter_response --fs 400 --gyro 4:30:bessel --angacc 2:30:bessel
+//
+// Cutoffs are in Hz, or in rad/s as the SFILT_*_FREQ parameters with --rad. Filters are
+// Butterworth unless a family from FilterDesign.hpp follows the cutoff.
+
+#include "FilterDesign.hpp"
+#include "FilterResponse.hpp"
+#include "tool_args.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct Filter {
+    const char* name;
+    int order;
+    double cutoff_hz;
+    FilterFamily family;
+};
+
+struct Options {
+    double fs = 400;
+    Filter gyro{"gyro", 2, 30, FilterFamily::butterworth}, angacc{"angacc", 2, 30, FilterFamily::butterworth},
+           accel{"accel", 2, 30, FilterFamily::butterworth}, jerk{"jerk", 2, 30, FilterFamily::butterworth};
+    bool rad = false; // cutoffs given in rad/s
+    bool use_float = false; // coefficients rounded to float, as with CONFIG_IMU_FILTERING_FLOAT
+    bool direct = false; // whole polynomial instead of second-order sections
+    bool angacc_fused = false; // derivative chains from the value filter, see butter_derivative()
+    bool jerk_fused = false;
+    double at_hz = 0; // frequency of interest, e.g. the control bandwidth, 0 for fs / 20
+    double fmin = 0; // table range, 0 for fs / 1000 and 0.49 fs
+    double fmax = 0;
+    int points = 30;
+    const char* table = nullptr;
+    const char* csv = nullptr;
+};
+
+struct Response {
+    const char* name;
+    ResponseChain chain;
+    bool differentiator; // shown relative to an ideal differentiator
+};
+
+template <typename T>
+void add_filter(ResponseChain& chain, const Filter& f, const Options& opt)
+{
+    if (opt.direct) {
+        chain.add(filter_synth<T>(f.family, f.order, f.cutoff_hz, opt.fs));
+    } else {
+        chain.add(filter_synth_sos<T>(f.family, f.order, f.cutoff_hz, opt.fs));
+    }
+}
+
+template <typename T>
+void add_derivative(ResponseChain& chain, const Filter& value, const Filter& derivative, bool fused, const Options& opt)
+{
+    if (!fused) {
+        add_filter<T>(chain, value, opt);
+        chain.addDifference();
+        add_filter<T>(chain, derivative, opt);
+    } else if (opt.direct) {
+        chain.add(butter_derivative(filter_synth<T>(value.family, value.order, value.cutoff_hz, opt.fs), opt.fs));
+    } else {
+        chain.add(butter_derivative(filter_synth_sos<T>(value.family, value.order, value.cutoff_hz, opt.fs), opt.fs));
+    }
+}
+
+template <typename T>
+std::vector<Response> build(const Options& opt)
+{
+    std::vector<Response> r;
+    const Filter* filters[] = {&opt.gyro, &opt.angacc, &opt.accel, &opt.jerk};
+    for (const Filter* f : filters) {
+        if ((f == &opt.angacc && opt.angacc_fused) || (f == &opt.jerk && opt.jerk_fused)) continue; // unused
+        r.push_back({f->name, ResponseChain(opt.fs), false});
+        add_filter<T>(r.back().chain, *f, opt);
+    }
+
+    r.push_back({"angacc_chain", ResponseChain(opt.fs), true});
+    add_derivative<T>(r.back().chain, opt.gyro, opt.angacc, opt.angacc_fused, opt);
+    r.push_back({"jerk_chain", ResponseChain(opt.fs), true});
+    add_derivative<T>(r.back().chain, opt.accel, opt.jerk, opt.jerk_fused, opt);
+    return r;
+}
+
+// Response on the grid, divided by j 2 pi f for a differentiating chain. The phase is unwrapped on a
+// grid refined between the given frequencies, so that a coarse grid does not skip a full turn.
+std::vector<FrequencyResponse> evaluate(const Response& r, const std::vector<double>& f)
+{
+    constexpr int REFINE = 32;
+    std::vector<double> fine;
+    for (std::size_t i = 0; i < f.size(); ++i) {
+        for (int k = 0; k < (i == 0 ? 1 : REFINE); ++k) {
+            fine.push_back(i == 0 ? f[0] : f[i - 1] + (f[i] - f[i - 1]) * (k + 1) / REFINE);
+        }
+    }
+    std::vector<FrequencyResponse> all(fine.size()), out(f.size());
+    r.chain.evaluate(fine.data(), fine.size(), all.data());
+    for (std::size_t i = 0; i < f.size(); ++i) out[i] = all[i == 0 ? 0 : i * REFINE];
+
+    if (r.differentiator) {
+        for (FrequencyResponse& p : out) {
+            p.magnitude /= 2 * M_PI * p.f;
+            p.phase_rad -= M_PI / 2;
+        }
+    }
+    return out;
+}
+
+std::vector<double> log_grid(double fmin, double fmax, int n)
+{
+    std::vector<double> f(n);
+    for (int i = 0; i < n; ++i) f[i] = n > 1 ? fmin * std::pow(fmax / fmin, static_cast<double>(i) / (n - 1)) : fmin;
+    return f;
+}
+
+double db(double magnitude) { return 20 * std::log10(magnitude); }
+double deg(double rad) { return rad * 180 / M_PI; }
+
+void print_table(const Response& r, const std::vector<FrequencyResponse>& points)
+{
+    std::printf("\n%s%s\n", r.name, r.differentiator ? " (relative to an ideal differentiator)" : "");
+    std::printf("%12s %10s %10s %12s\n", "freq [Hz]", "gain [dB]", "phase [deg]", "delay [ms]");
+    for (const FrequencyResponse& p : points) {
+        std::printf("%12.3f %10.2f %10.2f %12.3f\n", p.f, db(p.magnitude), deg(p.phase_rad), p.group_delay_s * 1e3);
+    }
+}
+
+template <typename T>
+int analyze(const Options& opt)
+{
+    const double fmin = opt.fmin > 0 ? opt.fmin : opt.fs / 1000;
+    const double fmax = opt.fmax > 0 ? opt.fmax : 0.49 * opt.fs;
+    const double at = opt.at_hz > 0 ? opt.at_hz : opt.fs / 20;
+    const std::vector<Response> responses = build<T>(opt);
+
+    // dense grid for the -3 dB frequency, with the frequency of interest on it
+    std::vector<double> dense = log_grid(fmin, fmax, 4000);
+    dense.push_back(at);
+    std::sort(dense.begin(), dense.end());
+    const std::size_t at_index = std::lower_bound(dense.begin(), dense.end(), at) - dense.begin();
+
+    std::printf("fs %.1f Hz, %s, %s coefficients\n", opt.fs, opt.direct ? "direct form" : "second-order sections",
+                opt.use_float ? "float" : "double");
+    const Filter* filters[] = {&opt.gyro, &opt.angacc, &opt.accel, &opt.jerk};
+    for (const Filter* f : filters) {
+        if (f == &opt.angacc && opt.angacc_fused) {
+            std::printf("%-7s fused with the gyro filter\n", f->name);
+        } else if (f == &opt.jerk && opt.jerk_fused) {
+            std::printf("%-7s fused with the accel filter\n", f->name);
+        } else {
+            std::printf("%-7s %-17s order %2d, cutoff %8.2f Hz (%8.1f rad/s)\n", f->name, filter_family_name(f->family), f->order,
+                        f->cutoff_hz, f->cutoff_hz * 2 * M_PI);
+        }
+    }
+
+    std::printf("\n%-13s %10s %10s %10s %10s %10s %12s %10s\n", "", "-3dB [Hz]", "delay0[ms]", "gain@f[dB]",
+                "phase@f", "delay@f[ms]", "pole radius", "margin");
+    bool stable = true;
+    for (const Response& r : responses) {
+        const std::vector<FrequencyResponse> p = evaluate(r, dense);
+        const double reference = p.front().magnitude; // passband gain, 1 up to rounding
+        double f3db = NAN;
+        for (const FrequencyResponse& q : p) {
+            if (q.magnitude < reference / std::sqrt(2.0)) {
+                f3db = q.f;
+                break;
+            }
+        }
+        const double radius = r.chain.maxPoleRadius();
+        stable = stable && radius < 1;
+        std::printf("%-13s %10.2f %10.3f %10.2f %10.2f %10.3f %12.8f %10.2e\n", r.name, f3db, p.front().group_delay_s * 1e3,
+                    db(p[at_index].magnitude), deg(p[at_index].phase_rad), p[at_index].group_delay_s * 1e3, radius, 1 - radius);
+    }
+    std::printf("(@f is %.2f Hz, phase in deg, margin is 1 - pole radius)\n", at);
+
+    const std::vector<double> grid = log_grid(fmin, fmax, opt.points);
+    for (const Response& r : responses) {
+        if (opt.table != nullptr && (std::strcmp(opt.table, "all") == 0 || std::strcmp(opt.table, r.name) == 0)) {
+            print_table(r, evaluate(r, grid));
+        }
+    }
+
+    if (opt.csv != nullptr) {
+        FILE* f = std::fopen(opt.csv, "w");
+        if (f == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", opt.csv);
+            return 2;
+        }
+        std::fprintf(f, "response,freq_hz,gain_db,phase_deg,group_delay_ms\n");
+        for (const Response& r : responses) {
+            for (const FrequencyResponse& p : evaluate(r, grid)) {
+                std::fprintf(f, "%s,%.6g,%.6g,%.6g,%.6g\n", r.name, p.f, db(p.magnitude), deg(p.phase_rad), p.group_delay_s * 1e3);
+            }
+        }
+        std::fclose(f);
+    }
+
+    if (!stable) std::printf("\nunstable: a pole is on or outside the unit circle\n");
+    return stable ? 0 : 1;
+}
+
+int usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--fs HZ] [--gyro N:FC[:TYPE]] [--angacc N:FC[:TYPE]] [--accel N:FC[:TYPE]]\n"
+                 "          [--jerk N:FC[:TYPE]] [--rad] [--fused angacc|jerk|both] [--float] [--direct]\n"
+                 "          [--at HZ] [--fmin HZ] [--fmax HZ] [--points N]\n"
+                 "          [--table gyro|angacc|accel|jerk|angacc_chain|jerk_chain|all] [--csv FILE]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--rad") == 0) {
+            opt.rad = true;
+            continue;
+        } else if (std::strcmp(arg, "--float") == 0) {
+            opt.use_float = true;
+            continue;
+        } else if (std::strcmp(arg, "--direct") == 0) {
+            opt.direct = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) return usage(argv[0]);
+        const char* value = argv[++i];
+        bool ok = true;
+        if (std::strcmp(arg, "--fs") == 0) {
+            opt.fs = std::atof(value);
+        } else if (std::strcmp(arg, "--gyro") == 0) {
+            ok = parse_filter(value, opt.gyro.family, opt.gyro.order, opt.gyro.cutoff_hz);
+        } else if (std::strcmp(arg, "--angacc") == 0) {
+            ok = parse_filter(value, opt.angacc.family, opt.angacc.order, opt.angacc.cutoff_hz);
+        } else if (std::strcmp(arg, "--accel") == 0) {
+            ok = parse_filter(value, opt.accel.family, opt.accel.order, opt.accel.cutoff_hz);
+        } else if (std::strcmp(arg, "--jerk") == 0) {
+            ok = parse_filter(value, opt.jerk.family, opt.jerk.order, opt.jerk.cutoff_hz);
+        } else if (std::strcmp(arg, "--fused") == 0) {
+            ok = parse_fused(value, opt.angacc_fused, opt.jerk_fused);
+        } else if (std::strcmp(arg, "--at") == 0) {
+            opt.at_hz = std::atof(value);
+        } else if (std::strcmp(arg, "--fmin") == 0) {
+            opt.fmin = std::atof(value);
+        } else if (std::strcmp(arg, "--fmax") == 0) {
+            opt.fmax = std::atof(value);
+        } else if (std::strcmp(arg, "--points") == 0) {
+            opt.points = std::atoi(value);
+        } else if (std::strcmp(arg, "--table") == 0) {
+            opt.table = value;
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            opt.csv = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) return usage(argv[0]);
+    }
+
+    if (opt.rad) {
+        for (Filter* f : {&opt.gyro, &opt.angacc, &opt.accel, &opt.jerk}) f->cutoff_hz /= 2 * M_PI;
+    }
+    for (const Filter* f : {&opt.gyro, &opt.angacc, &opt.accel, &opt.jerk}) {
+        if (!(f->cutoff_hz < opt.fs / 2)) {
+            std::fprintf(stderr, "%s cutoff %.2f Hz is not below the Nyquist frequency %.2f Hz\n", f->name, f->cutoff_hz, opt.fs / 2);
+            return 2;
+        }
+    }
+    if ((opt.angacc_fused && !filter_all_pole(opt.gyro.family)) || (opt.jerk_fused && !filter_all_pole(opt.accel.family))) {
+        std::fprintf(stderr, "a fused derivative needs all zeros at z = -1, not %s\n", filter_family_name(FilterFamily::chebyshev2));
+        return 2;
+    }
+    if (!(opt.fs > 0) || opt.points < 2 || (opt.fmax > 0 && opt.fmax >= opt.fs / 2)) return usage(argv[0]);
+
+    return opt.use_float ? analyze<float>(opt) : analyze<double>(opt);
+}
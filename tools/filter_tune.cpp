@@ -0,0 +1,490 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Sweeps the orders, cutoffs and families of the four filters over the IMU data of one or more
+// flight logs and prints, for the angular rate, angular acceleration, acceleration and jerk, the
+// candidates that no other candidate beats on both noise and delay:
+//
+//     filter_tune flight1.ulg flight2.ulg --orders 1:4 --cutoffs 10:150:5 --csv sweep.csv
+//
+// The angular rate and acceleration filters are swept together, as both are set by the same
+// candidate, and then the angular acceleration and jerk filters, including the fused derivatives,
+// behind the value filters given with --gyro and --accel. Every candidate runs the logs through
+// ImuFilterCore at their measured sample rate, as ulog_replay does in one pass.
+//
+// Noise is the power of the output above --noise-from, summed over the axes, measured with a
+// fourth-order high-pass filter after the first --settle seconds of each log. Delay is the group
+// delay of the filter or derivative chain at --at (see FilterResponse.hpp). Both are averaged over
+// the logs weighted by their samples.
+//
+// The logs are decoded once into rows held in memory and shared read-only by a pool of threads,
+// one per core unless --threads says otherwise, that take candidates one at a time.
+
+#include "FilterResponse.hpp"
+#include "ImuFilterCore.hpp"
+#include "ImuLog.hpp"
+#include "tool_args.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int LANES = ImuFilterCore<>::LANES;
+
+struct Options {
+    std::vector<const char*> inputs;
+    int order_min = 1;
+    int order_max = 4;
+    double cutoff_min = 10; // Hz
+    double cutoff_max = 150;
+    double cutoff_step = 10;
+    std::vector<FilterFamily> families {FilterFamily::butterworth};
+    ImuFilterConfig fixed {}; // value filters in front of the derivative candidates
+    double noise_hz = 40;
+    double at_hz = 10;
+    double settle_s = 1;
+    int threads = 0; // 0 for one per core
+    int instance = 0;
+    bool use_float = false;
+    const char* csv = nullptr;
+};
+
+enum Output { RATE, ANGACC, ACCEL, JERK, OUTPUTS };
+
+struct OutputInfo {
+    const char* name;
+    const char* unit; // of the noise power
+    const char* order_param;
+    const char* freq_param;
+};
+
+constexpr OutputInfo OUTPUT_INFO[OUTPUTS] {
+    {"angular rate", "(rad/s)^2", "SFILT_GYRO_N", "SFILT_GYRO_FREQ"},
+    {"angular acceleration", "(rad/s^2)^2", "SFILT_AACC_N", "SFILT_AACC_FREQ"},
+    {"acceleration", "(m/s^2)^2", "SFILT_ACCEL_N", "SFILT_ACCEL_FREQ"},
+    {"jerk", "(m/s^3)^2", "SFILT_JRK_N", "SFILT_JRK_FREQ"},
+};
+
+// A filter tried for the two value filters or, with derivative set, for the two derivative
+// filters; fused takes the derivatives from the value filters instead
+struct Candidate {
+    bool derivative = false;
+    bool fused = false;
+    FilterFamily family = FilterFamily::butterworth;
+    int order = 0;
+    double cutoff_hz = 0;
+};
+
+struct Score {
+    bool valid = false;
+    double noise[2] {}; // gyro and accelerometer group
+    double delay_s[2] {};
+};
+
+// Fourth-order Butterworth high-pass filter on AXES lanes, in double whatever the filters run in
+class NoiseMeter {
+public:
+    static constexpr int AXES = 3;
+
+    void configure(double fc, double fs) {
+        constexpr double Q[2] {0.54119610, 1.30656296}; // 1 / (2 cos(pi/8)), 1 / (2 cos(3 pi/8))
+        const double k = std::tan(M_PI * fc / fs);
+        for (int s = 0; s < 2; ++s) {
+            const double norm = 1 / (1 + k / Q[s] + k * k);
+            b0_[s] = norm;
+            a1_[s] = 2 * (k * k - 1) * norm;
+            a2_[s] = (1 - k / Q[s] + k * k) * norm;
+        }
+        for (int s = 0; s < 2; ++s) {
+            for (int a = 0; a < AXES; ++a) {
+                z1_[s][a] = 0;
+                z2_[s][a] = 0;
+            }
+        }
+    }
+
+    // Filters n rows of which the AXES values from lane first are taken, stride values apart, and
+    // returns the sum over the axes and rows of the squared output of the rows from skip on
+    template <typename T>
+    double push(const T* rows, std::size_t n, std::size_t stride, int first, std::size_t skip) {
+        double sum = 0;
+        for (std::size_t t = 0; t < n; ++t) {
+            for (int a = 0; a < AXES; ++a) {
+                double y = static_cast<double>(rows[t * stride + first + a]);
+                for (int s = 0; s < 2; ++s) { // transposed direct form II, numerator b0 (1, -2, 1)
+                    const double x = y;
+                    y = b0_[s] * x + z1_[s][a];
+                    z1_[s][a] = -2 * b0_[s] * x - a1_[s] * y + z2_[s][a];
+                    z2_[s][a] = b0_[s] * x - a2_[s] * y;
+                }
+                if (t >= skip) sum += y * y;
+            }
+        }
+        return sum;
+    }
+
+private:
+    double b0_[2] {}, a1_[2] {}, a2_[2] {};
+    double z1_[2][AXES] {}, z2_[2][AXES] {};
+};
+
+// The config a candidate is run with: the candidate's filters for both groups, the others fixed
+ImuFilterConfig candidate_config(const Candidate& c, const ImuFilterConfig& fixed)
+{
+    ImuFilterConfig config = fixed;
+    config.notch_count = 0;
+    config.spectrum_rate_hz = 0;
+    if (!c.derivative) {
+        config.gyro_family = config.accel_family = c.family;
+        config.gyro_order = config.accel_order = c.order;
+        config.gyro_cutoff_hz = config.accel_cutoff_hz = c.cutoff_hz;
+    } else {
+        config.angacc_fused = config.jerk_fused = c.fused;
+        if (!c.fused) {
+            config.angacc_family = config.jerk_family = c.family;
+            config.angacc_order = config.jerk_order = c.order;
+            config.angacc_cutoff_hz = config.jerk_cutoff_hz = c.cutoff_hz;
+        }
+    }
+    return config;
+}
+
+// Group delay at f of the output of a group, the value filter or the derivative chain
+template <typename T>
+double delay_at(const ImuFilterConfig& config, int group, bool derivative, double fs, double f)
+{
+    const FilterFamily family = group == 0 ? config.gyro_family : config.accel_family;
+    const int order = group == 0 ? config.gyro_order : config.accel_order;
+    const double cutoff = group == 0 ? config.gyro_cutoff_hz : config.accel_cutoff_hz;
+    const IIR_SOST<T> value = filter_synth_sos<T>(family, order, cutoff, fs);
+
+    ResponseChain chain(fs);
+    if (!derivative) {
+        chain.add(value);
+    } else if (group == 0 ? config.angacc_fused : config.jerk_fused) {
+        chain.add(butter_derivative(value, fs));
+    } else {
+        chain.add(value).addDifference();
+        if (group == 0) chain.add(filter_synth_sos<T>(config.angacc_family, config.angacc_order, config.angacc_cutoff_hz, fs));
+        else chain.add(filter_synth_sos<T>(config.jerk_family, config.jerk_order, config.jerk_cutoff_hz, fs));
+    }
+    return chain.groupDelay(f);
+}
+
+// Runs every log through the filters of a candidate and scores its two outputs
+template <typename T>
+Score evaluate(const Candidate& c, const std::vector<ImuRecording>& logs, const Options& opt)
+{
+    constexpr std::size_t ROWS = 256; // rows copied from the shared buffer per call
+    const ImuFilterConfig config = candidate_config(c, opt.fixed);
+    Score score;
+    double weight = 0;
+    T x[ROWS * LANES], dx[ROWS * LANES];
+
+    for (const ImuRecording& log : logs) {
+        if (opt.noise_hz >= log.rate_hz / 2) return score;
+        ImuFilterCore<T> core;
+        if (!core.configure(config, log.rate_hz)) return score;
+        NoiseMeter meters[2];
+        for (NoiseMeter& m : meters) m.configure(opt.noise_hz, log.rate_hz);
+
+        const std::size_t settle = static_cast<std::size_t>(opt.settle_s * log.rate_hz);
+        const T dt_s = static_cast<T>(1 / log.rate_hz);
+        double sum[2] {};
+        std::size_t run = 0;
+        for (std::size_t start = 0; start < log.size();) {
+            // chunks end at the next gap, where the filters warm-start as in the module
+            while (run < log.runs.size() && log.runs[run] <= start) {
+                if (log.runs[run] == start) core.restart();
+                ++run;
+            }
+            const std::size_t end = run < log.runs.size() ? log.runs[run] : log.size();
+            const std::size_t n = std::min(ROWS, end - start);
+            const float* rows = log.rows.data() + start * LANES;
+            for (std::size_t i = 0; i < n * LANES; ++i) x[i] = static_cast<T>(rows[i]);
+            core.processBuffer(x, dx, n, dt_s);
+
+            const T* out = c.derivative ? dx : x;
+            const std::size_t skip = start < settle ? settle - start : 0;
+            sum[0] += meters[0].push(out, n, LANES, ImuFilterCore<T>::GYRO, skip);
+            sum[1] += meters[1].push(out, n, LANES, ImuFilterCore<T>::ACCEL, skip);
+            start += n;
+        }
+
+        if (log.size() <= settle) continue;
+        const double scored = static_cast<double>(log.size() - settle);
+        for (int g = 0; g < 2; ++g) {
+            score.noise[g] += sum[g];
+            score.delay_s[g] += scored * delay_at<T>(config, g, c.derivative, log.rate_hz, opt.at_hz);
+        }
+        weight += scored;
+    }
+
+    if (!(weight > 0)) return score;
+    for (int g = 0; g < 2; ++g) {
+        score.noise[g] /= weight;
+        score.delay_s[g] /= weight;
+    }
+    score.valid = true;
+    return score;
+}
+
+std::vector<Candidate> candidates(const Options& opt)
+{
+    std::vector<Candidate> all;
+    for (int derivative = 0; derivative < 2; ++derivative) {
+        for (FilterFamily family : opt.families) {
+            for (int order = opt.order_min; order <= opt.order_max; ++order) {
+                // a whole number of steps, up to the rounding of the step
+                const int steps = static_cast<int>(std::floor((opt.cutoff_max - opt.cutoff_min) / opt.cutoff_step + 1e-9));
+                for (int i = 0; i <= steps; ++i) {
+                    all.push_back({derivative != 0, false, family, order, opt.cutoff_min + i * opt.cutoff_step});
+                }
+            }
+        }
+    }
+    all.push_back({true, true, FilterFamily::butterworth, 0, 0});
+    return all;
+}
+
+struct Point {
+    std::size_t candidate;
+    double delay_s;
+    double noise;
+    bool front;
+};
+
+// Marks the points that no other point beats on both delay and noise
+void pareto(std::vector<Point>& points)
+{
+    std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+        return a.delay_s < b.delay_s || (a.delay_s == b.delay_s && a.noise < b.noise);
+    });
+    double best = INFINITY;
+    for (Point& p : points) {
+        p.front = p.noise < best;
+        if (p.front) best = p.noise;
+    }
+}
+
+void describe(const Candidate& c, const ImuFilterConfig& fixed, int output, char* text, std::size_t size)
+{
+    if (c.fused) {
+        const FilterFamily f = output == ANGACC ? fixed.gyro_family : fixed.accel_family;
+        std::snprintf(text, size, "fused %s", filter_family_name(f));
+    } else {
+        std::snprintf(text, size, "%s", filter_family_name(c.family));
+    }
+}
+
+template <typename T>
+int tune(const Options& opt)
+{
+    std::vector<ImuRecording> logs(opt.inputs.size());
+    std::size_t rows = 0;
+    for (std::size_t i = 0; i < logs.size(); ++i) {
+        std::string error;
+        if (!logs[i].load(opt.inputs[i], opt.instance, error)) {
+            std::fprintf(stderr, "%s: %s\n", opt.inputs[i], error.c_str());
+            return 2;
+        }
+        std::printf("%s: %zu samples at %.1f Hz in %zu runs%s\n", opt.inputs[i], logs[i].size(), logs[i].rate_hz,
+                    logs[i].runs.size(), logs[i].has_accel ? "" : ", no vehicle_acceleration");
+        rows += logs[i].size();
+    }
+
+    const std::vector<Candidate> all = candidates(opt);
+    std::vector<Score> scores(all.size());
+    const int threads = opt.threads > 0 ? opt.threads : std::max(1u, std::thread::hardware_concurrency());
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> next {0};
+    std::vector<std::thread> pool;
+    for (int w = 0; w < threads; ++w) {
+        pool.emplace_back([&] {
+            for (std::size_t i = next++; i < all.size(); i = next++) scores[i] = evaluate<T>(all[i], logs, opt);
+        });
+    }
+    for (std::thread& t : pool) t.join();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::printf("%zu candidates over %zu samples in %.2f s on %d threads, %.0f M samples/s\n", all.size(), rows,
+                elapsed, threads, all.size() * rows / elapsed / 1e6);
+    std::printf("noise: power above %.1f Hz after %.1f s, delay: group delay at %.1f Hz\n", opt.noise_hz, opt.settle_s,
+                opt.at_hz);
+
+    std::vector<Point> points[OUTPUTS];
+    std::size_t invalid = 0;
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        if (!scores[i].valid) {
+            invalid++;
+            continue;
+        }
+        const int first = all[i].derivative ? ANGACC : RATE;
+        points[first].push_back({i, scores[i].delay_s[0], scores[i].noise[0], false});
+        points[first + 2].push_back({i, scores[i].delay_s[1], scores[i].noise[1], false});
+    }
+    if (invalid > 0) std::printf("%zu candidates with an invalid design at the logged sample rates\n", invalid);
+
+    char family[64];
+    for (int o = 0; o < OUTPUTS; ++o) {
+        pareto(points[o]);
+        const OutputInfo& info = OUTPUT_INFO[o];
+        std::printf("\n%s, Pareto front of %zu candidates\n", info.name, points[o].size());
+        std::printf("%-18s %14s %18s %12s %14s\n", "family", info.order_param, info.freq_param, "delay [ms]", info.unit);
+        for (const Point& p : points[o]) {
+            if (!p.front) continue;
+            const Candidate& c = all[p.candidate];
+            describe(c, opt.fixed, o, family, sizeof(family));
+            if (c.fused) std::printf("%-18s %14s %18s", family, "-", "-");
+            else std::printf("%-18s %14d %18.1f", family, c.order, c.cutoff_hz * 2 * M_PI);
+            std::printf(" %12.3f %14.4g\n", p.delay_s * 1e3, p.noise);
+        }
+    }
+
+    if (opt.csv != nullptr) {
+        FILE* csv = std::fopen(opt.csv, "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", opt.csv);
+            return 2;
+        }
+        std::fprintf(csv, "output,family,fused,order,cutoff_hz,cutoff_radps,delay_ms,noise,pareto\n");
+        for (int o = 0; o < OUTPUTS; ++o) {
+            for (const Point& p : points[o]) {
+                const Candidate& c = all[p.candidate];
+                const FilterFamily f = !c.fused ? c.family : (o == ANGACC ? opt.fixed.gyro_family : opt.fixed.accel_family);
+                std::fprintf(csv, "%s,%s,%d,%d,%.9g,%.9g,%.9g,%.9g,%d\n", OUTPUT_INFO[o].name, filter_family_name(f),
+                             c.fused ? 1 : 0, c.order, c.cutoff_hz, c.cutoff_hz * 2 * M_PI, p.delay_s * 1e3, p.noise,
+                             p.front ? 1 : 0);
+            }
+        }
+        if (std::fclose(csv) != 0) {
+            std::fprintf(stderr, "error writing %s\n", opt.csv);
+            return 2;
+        }
+    }
+    return 0;
+}
+
+// Parses MIN:MAX orders
+bool parse_orders(const char* arg, int& min, int& max)
+{
+    char* end = nullptr;
+    const long a = std::strtol(arg, &end, 10);
+    if (*end != ':') return false;
+    const long b = std::strtol(end + 1, &end, 10);
+    if (*end != '\0' || a < 1 || b < a || b > BUTTERWORTH_MAX_ORDER) return false;
+    min = static_cast<int>(a);
+    max = static_cast<int>(b);
+    return true;
+}
+
+// Parses MIN:MAX:STEP cutoffs in Hz
+bool parse_cutoffs(const char* arg, double& min, double& max, double& step)
+{
+    char* end = nullptr;
+    const double a = std::strtod(arg, &end);
+    if (*end != ':') return false;
+    const double b = std::strtod(end + 1, &end);
+    if (*end != ':') return false;
+    const double s = std::strtod(end + 1, &end);
+    if (*end != '\0' || !(a > 0) || !(b >= a) || !(s > 0)) return false;
+    min = a;
+    max = b;
+    step = s;
+    return true;
+}
+
+// Parses a comma separated list of families named as by filter_family_name()
+bool parse_families(const char* arg, std::vector<FilterFamily>& families)
+{
+    std::vector<FilterFamily> list;
+    const std::string text(arg);
+    std::size_t start = 0;
+    while (start <= text.size()) {
+        std::size_t comma = text.find(',', start);
+        if (comma == std::string::npos) comma = text.size();
+        const std::string name = text.substr(start, comma - start);
+        int i = 0;
+        while (i < FILTER_FAMILIES && name != filter_family_name(filter_family(i))) ++i;
+        if (i == FILTER_FAMILIES) return false;
+        list.push_back(filter_family(i));
+        start = comma + 1;
+    }
+    families = list;
+    return true;
+}
+
+int usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s LOG.ulg... [--orders MIN:MAX] [--cutoffs MIN:MAX:STEP] [--families LIST]\n"
+                 "          [--gyro ORDER:CUTOFF[:FAMILY]] [--accel ORDER:CUTOFF[:FAMILY]] [--noise-from HZ] [--at HZ]\n"
+                 "          [--settle S] [--threads N] [--instance N] [--float] [--csv FILE]\n"
+                 "  cutoffs in Hz, families e.g. butterworth,bessel\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (arg[0] != '-') {
+            opt.inputs.push_back(arg);
+            continue;
+        }
+        if (std::strcmp(arg, "--float") == 0) {
+            opt.use_float = true;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) return usage(argv[0]);
+        ++i;
+        bool ok = true;
+        if (std::strcmp(arg, "--orders") == 0) {
+            ok = parse_orders(value, opt.order_min, opt.order_max);
+        } else if (std::strcmp(arg, "--cutoffs") == 0) {
+            ok = parse_cutoffs(value, opt.cutoff_min, opt.cutoff_max, opt.cutoff_step);
+        } else if (std::strcmp(arg, "--families") == 0) {
+            ok = parse_families(value, opt.families);
+        } else if (std::strcmp(arg, "--gyro") == 0) {
+            ok = parse_filter(value, opt.fixed.gyro_family, opt.fixed.gyro_order, opt.fixed.gyro_cutoff_hz);
+        } else if (std::strcmp(arg, "--accel") == 0) {
+            ok = parse_filter(value, opt.fixed.accel_family, opt.fixed.accel_order, opt.fixed.accel_cutoff_hz);
+        } else if (std::strcmp(arg, "--noise-from") == 0) {
+            opt.noise_hz = std::atof(value);
+            ok = opt.noise_hz > 0;
+        } else if (std::strcmp(arg, "--at") == 0) {
+            opt.at_hz = std::atof(value);
+            ok = opt.at_hz > 0;
+        } else if (std::strcmp(arg, "--settle") == 0) {
+            opt.settle_s = std::atof(value);
+            ok = opt.settle_s >= 0;
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            opt.threads = std::atoi(value);
+            ok = opt.threads >= 0;
+        } else if (std::strcmp(arg, "--instance") == 0) {
+            opt.instance = std::atoi(value);
+            ok = opt.instance >= 0;
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            opt.csv = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) return usage(argv[0]);
+    }
+    if (opt.inputs.empty()) return usage(argv[0]);
+
+    return opt.use_float ? tune<float>(opt) : tune<double>(opt);
+}
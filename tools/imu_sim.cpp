@@ -0,0 +1,492 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Host simulation of the imu_filtering pipeline: synthetic IMU streams are run through
+// ImuFilterCore, the code the PX4 module runs, either row by row as on vehicle_angular_velocity
+// or in batches as on sensor_gyro_fifo. The tool reports throughput, checks every output against
+// an independent scalar implementation, and reports what the filters did to the signal.
+//
+//     imu_sim --signal vibration --rate 400 --seconds 60
+//     imu_sim --signal sweep --rate 8000 --batch 32 --decimation 4 --gyro 4:80
+//     imu_sim --signal noise --float --csv out.csv
+//     imu_sim --signal vibration --fused both       derivatives from the value filters
+//     imu_sim --signal sweep --gyro 4:30:bessel
+//     imu_sim --signal vibration --notch 2:80:250:20:both --gyro 2:80   dynamic notches, higher cutoff
+//     imu_sim --signal vibration --spectrum 1      spectrum monitor, its last report
+//
+// Signals, on all six lanes with a different phase per lane:
+//     sweep      logarithmic chirp of unit amplitude from 1 Hz to 45% of the filter rate, the
+//                gain of the angular rate filter is measured along it
+//     noise      white Gaussian noise of unit variance
+//     vibration  slow vehicle motion, motor vibration at 150-190 Hz with two harmonics and
+//                sensor noise, the filtered outputs are compared with the true motion
+
+#include "ButterworthFilt.hpp"
+#include "FilterResponse.hpp"
+#include "ImuFilterCore.hpp"
+#include "tool_args.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+enum class Signal { sweep, noise, vibration };
+
+struct Options {
+    Signal signal = Signal::vibration;
+    double rate_hz = 400;
+    double seconds = 60;
+    int batch = 0; // rows per processBuffer() call, 0 to filter row by row with step()
+    int decimation = 1;
+    int repeat = 3; // timed runs, the fastest one is reported
+    bool use_float = false;
+    unsigned seed = 1;
+    const char* csv = nullptr;
+    ImuFilterConfig config;
+};
+
+constexpr int LANES = ImuFilterCore<>::LANES;
+constexpr int GYRO = ImuFilterCore<>::GYRO;
+constexpr int ACCEL = ImuFilterCore<>::ACCEL;
+
+// Motion and its derivative on each lane, exact, for the vibration signal
+struct Motion {
+    double value[LANES];
+    double derivative[LANES];
+};
+
+Motion vehicle_motion(double t)
+{
+    Motion m{};
+    for (int l = 0; l < LANES; ++l) {
+        const double f1 = 0.7 + 0.3 * l, f2 = 2.3 + 0.2 * l; // a few Hz, well inside every passband
+        const double w1 = 2 * M_PI * f1, w2 = 2 * M_PI * f2;
+        m.value[l] = 0.5 * std::sin(w1 * t + l) + 0.2 * std::sin(w2 * t);
+        m.derivative[l] = 0.5 * w1 * std::cos(w1 * t + l) + 0.2 * w2 * std::cos(w2 * t);
+        if (l >= ACCEL) m.value[l] += (l == ACCEL + 2) ? -9.81 : 0; // gravity on z
+    }
+    return m;
+}
+
+// Row-major rows of LANES values, and the true motion for the vibration signal
+void generate(const Options& opt, std::vector<double>& rows, std::vector<double>& truth,
+              std::vector<double>& truth_derivative)
+{
+    const std::size_t n = static_cast<std::size_t>(opt.seconds * opt.rate_hz);
+    rows.assign(n * LANES, 0);
+    std::mt19937 rng(opt.seed);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+
+    if (opt.signal == Signal::vibration) {
+        truth.assign(n * LANES, 0);
+        truth_derivative.assign(n * LANES, 0);
+    }
+
+    const double f0 = 1, f1 = 0.45 * opt.rate_hz / opt.decimation;
+    double motor_phase = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double t = i / opt.rate_hz;
+        double* row = &rows[i * LANES];
+
+        switch (opt.signal) {
+        case Signal::sweep: {
+            // phase of a logarithmic chirp from f0 to f1 over the whole signal
+            const double k = std::log(f1 / f0) / opt.seconds;
+            const double phase = 2 * M_PI * f0 * (std::exp(k * t) - 1) / k;
+            for (int l = 0; l < LANES; ++l) row[l] = std::sin(phase + l);
+            break;
+        }
+        case Signal::noise:
+            for (int l = 0; l < LANES; ++l) row[l] = gauss(rng);
+            break;
+        case Signal::vibration: {
+            const Motion m = vehicle_motion(t);
+            const double motor_hz = 170 + 20 * std::sin(2 * M_PI * 0.1 * t); // throttle changes
+            motor_phase += 2 * M_PI * motor_hz / opt.rate_hz;
+            for (int l = 0; l < LANES; ++l) {
+                const double vibration = 0.8 * std::sin(motor_phase + l) + 0.3 * std::sin(2 * motor_phase + 2 * l)
+                                       + 0.1 * std::sin(3 * motor_phase + 3 * l);
+                row[l] = m.value[l] + vibration + 0.05 * gauss(rng);
+                truth[i * LANES + l] = m.value[l];
+                truth_derivative[i * LANES + l] = m.derivative[l];
+            }
+            break;
+        }
+        }
+    }
+}
+
+// Filtered rows and their derivatives, one row per filter output
+template <typename T>
+struct Outputs {
+    std::vector<T> x, dx;
+    std::size_t rows = 0;
+    std::vector<std::size_t> input_row; // input row each output row belongs to
+    float notch_hz[PeakEstimator::MAX_PEAKS] = {}; // dynamic notch centres after the last row
+    typename ImuFilterCore<T>::Spectrum::Report spectrum; // last report of the spectrum monitor
+    unsigned spectrum_reports = 0;
+};
+
+template <typename T>
+void run_core(const Options& opt, const std::vector<T>& in, Outputs<T>& out)
+{
+    ImuFilterCore<T> core;
+    core.setDecimation(opt.decimation);
+    if (!core.configure(opt.config, opt.rate_hz / core.decimation())) {
+        std::fprintf(stderr, "invalid filter design at %.1f Hz\n", opt.rate_hz / core.decimation());
+        std::exit(2);
+    }
+
+    const std::size_t n = in.size() / LANES;
+    const T dt_s = static_cast<T>(1 / opt.rate_hz);
+    out.x.resize(in.size());
+    out.dx.resize(in.size());
+    out.input_row.resize(n);
+    out.rows = 0;
+
+    if (opt.batch == 0) {
+        for (std::size_t i = 0; i < n; ++i) {
+            // the first row warm-starts the filters, as after the first vehicle_angular_velocity sample
+            core.step(&in[i * LANES], i == 0 ? T(0) : dt_s, &out.x[i * LANES], &out.dx[i * LANES]);
+            out.input_row[i] = i;
+        }
+        out.rows = n;
+        for (int i = 0; i < core.notch().count(); ++i) out.notch_hz[i] = core.notch().center(i);
+        out.spectrum = core.spectrum().report();
+        out.spectrum_reports = core.spectrum().reports();
+        return;
+    }
+
+    std::vector<T> batch(static_cast<std::size_t>(opt.batch) * LANES), dbatch(batch.size());
+    for (std::size_t start = 0; start < n; start += opt.batch) {
+        const std::size_t m = n - start < static_cast<std::size_t>(opt.batch) ? n - start : opt.batch;
+        std::memcpy(batch.data(), &in[start * LANES], m * LANES * sizeof(T));
+        const std::size_t rows = core.processBuffer(batch.data(), dbatch.data(), m, dt_s);
+        std::memcpy(&out.x[out.rows * LANES], batch.data(), rows * LANES * sizeof(T));
+        std::memcpy(&out.dx[out.rows * LANES], dbatch.data(), rows * LANES * sizeof(T));
+        // the last output of a batch lags its last input by the rows still held by the decimator
+        const std::size_t last = start + m - 1 - core.pending();
+        for (std::size_t r = 0; r < rows; ++r) {
+            out.input_row[out.rows + r] = last - (rows - 1 - r) * core.decimation();
+        }
+        out.rows += rows;
+    }
+    for (int i = 0; i < core.notch().count(); ++i) out.notch_hz[i] = core.notch().center(i);
+    out.spectrum = core.spectrum().report();
+    out.spectrum_reports = core.spectrum().reports();
+}
+
+// Dynamic notches written out per lane: a transposed direct form II biquad per notch whose state is
+// kept when it is retuned, which happens after the row that completes an estimator frame
+template <typename T>
+struct ReferenceNotch {
+    PeakEstimator estimator;
+    float center[PeakEstimator::MAX_PEAKS] = {};
+    IIR_BiquadT<T> s[PeakEstimator::MAX_PEAKS];
+    T z[LANES][PeakEstimator::MAX_PEAKS][2] = {};
+
+    void design(const ImuFilterConfig& c, double fs) {
+        for (int i = 0; i < c.notch_count; ++i) s[i] = notch_synth<T>(center[i], c.notch_bandwidth_hz, fs);
+    }
+
+    void process(const ImuFilterConfig& c, double fs, T row[LANES]) {
+        const bool update = estimator.push(row, 1, LANES);
+        for (int l = 0; l < LANES; ++l) {
+            if (!(l < ACCEL ? c.notch_gyro : c.notch_accel)) continue;
+            for (int i = 0; i < c.notch_count; ++i) {
+                if (!(center[i] > 0)) continue;
+                const T x = row[l];
+                const T y = s[i].b[0] * x + z[l][i][0];
+                z[l][i][0] = s[i].b[1] * x - s[i].a[1] * y + z[l][i][1];
+                z[l][i][1] = s[i].b[2] * x - s[i].a[2] * y;
+                row[l] = y;
+            }
+        }
+        if (update && notch_track(estimator, center, c.notch_count, c.notch_bandwidth_hz, c.notch_min_hz, c.notch_max_hz)) {
+            design(c, fs);
+        }
+    }
+};
+
+// The same pipeline written out per lane with the scalar cascade, as the module did before the bank
+template <typename T>
+void run_reference(const Options& opt, const std::vector<T>& in, Outputs<T>& out)
+{
+    // the core synthesizes at cutoffs and rates rounded to its cache keys (CoeffCache defaults)
+    const auto fc = [](double f) { return std::llround(f / 0.01) * 0.01; };
+    const double fs = static_cast<double>(std::llround(opt.rate_hz / opt.decimation));
+    const ImuFilterConfig& c = opt.config;
+    ButterworthSOST<T> filter[LANES], derivative_filter[LANES];
+    bool fused[LANES];
+    for (int l = 0; l < LANES; ++l) {
+        const bool gyro = l < ACCEL;
+        const IIR_SOST<T> coeffs = filter_synth_sos<T>(gyro ? c.gyro_family : c.accel_family, gyro ? c.gyro_order : c.accel_order,
+                                                       fc(gyro ? c.gyro_cutoff_hz : c.accel_cutoff_hz), fs);
+        filter[l].setCoeffs(coeffs);
+        // a fused derivative is a separate filter on the input here, with the derivative numerator
+        fused[l] = gyro ? c.angacc_fused : c.jerk_fused;
+        derivative_filter[l].setCoeffs(fused[l] ? butter_derivative(coeffs, opt.rate_hz / opt.decimation)
+                                                : filter_synth_sos<T>(gyro ? c.angacc_family : c.jerk_family, gyro ? c.angacc_order : c.jerk_order,
+                                                                      fc(gyro ? c.angacc_cutoff_hz : c.jerk_cutoff_hz), fs));
+    }
+    PolyphaseDecimator<LANES, T> decimator(opt.decimation);
+
+    const std::size_t n = in.size() / LANES;
+    const T dt_s = static_cast<T>(opt.decimation / opt.rate_hz);
+    std::vector<T> rows(in);
+    if (n > 0) decimator.reset(rows.data()); // warm start at the first row, as in the core
+    const std::size_t m = opt.batch == 0 ? n : decimator.processBuffer(rows.data(), rows.data(), n);
+
+    ReferenceNotch<T> notch;
+    notch.estimator.configure(opt.rate_hz / opt.decimation, c.notch_min_hz, c.notch_max_hz);
+
+    out.x.resize(m * LANES);
+    out.dx.resize(m * LANES);
+    out.rows = m;
+    T prev[LANES] = {};
+    for (std::size_t i = 0; i < m; ++i) {
+        if (c.notch_count > 0) notch.process(c, opt.rate_hz / opt.decimation, &rows[i * LANES]);
+        for (int l = 0; l < LANES; ++l) {
+            if (i == 0) { // every filter starts at the steady state of the first row
+                filter[l].reset(rows[l]);
+                if (fused[l]) derivative_filter[l].reset(rows[l]);
+            }
+            const T y = filter[l].process(rows[i * LANES + l]);
+            out.x[i * LANES + l] = y;
+            if (fused[l]) {
+                out.dx[i * LANES + l] = derivative_filter[l].process(rows[i * LANES + l]);
+            } else {
+                out.dx[i * LANES + l] = i == 0 ? T(0) : derivative_filter[l].process((y - prev[l]) / dt_s);
+            }
+            prev[l] = y;
+        }
+    }
+}
+
+double rms(const double* x, std::size_t n, std::size_t stride)
+{
+    double sum = 0;
+    for (std::size_t i = 0; i < n; ++i) sum += x[i * stride] * x[i * stride];
+    return n > 0 ? std::sqrt(sum / n) : 0;
+}
+
+double design_gain(FilterFamily family, int N, double f, double fc, double fs) // magnitude of filter_synth at f
+{
+    ResponseChain chain(fs);
+    chain.add(filter_synth_sos<double>(family, N, fc, fs));
+    return std::abs(chain.freqz(f));
+}
+
+template <typename T>
+int simulate(const Options& opt)
+{
+    std::vector<double> signal, truth, truth_derivative;
+    generate(opt, signal, truth, truth_derivative);
+    const std::vector<T> in(signal.begin(), signal.end());
+    const std::size_t n = in.size() / LANES;
+
+    // throughput, best of opt.repeat runs over the whole signal
+    Outputs<T> out;
+    double best = 1e300;
+    for (int r = 0; r < opt.repeat; ++r) {
+        const auto t0 = std::chrono::steady_clock::now();
+        run_core(opt, in, out);
+        const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        best = t < best ? t : best;
+    }
+    const ImuFilterConfig& c = opt.config;
+    std::printf("%zu rows of %d samples at %.0f Hz, %s, %s, decimation %d%s%s\n", n, LANES, opt.rate_hz,
+                opt.use_float ? "float" : "double",
+                opt.batch == 0 ? "row by row" : "batches", opt.decimation,
+                c.angacc_fused && c.jerk_fused ? ", fused derivatives" : c.angacc_fused ? ", fused angacc"
+                : c.jerk_fused ? ", fused jerk" : "", c.notch_count > 0 ? ", dynamic notches" : "");
+    if (opt.batch > 0) std::printf("batch size %d\n", opt.batch);
+    std::printf("throughput: %.3g rows/s, %.3g samples/s, %.1f ns/row, %.0fx real time\n",
+                n / best, n * LANES / best, best * 1e9 / n, n / best / opt.rate_hz);
+
+    // every output against the scalar reference
+    Outputs<T> ref;
+    run_reference(opt, in, ref);
+    double max_error = 0, max_value = 0;
+    for (std::size_t i = 0; i < out.rows * LANES; ++i) {
+        max_error = std::fmax(max_error, std::fabs(double(out.x[i]) - double(ref.x[i])));
+        max_error = std::fmax(max_error, std::fabs(double(out.dx[i]) - double(ref.dx[i])));
+        max_value = std::fmax(max_value, std::fmax(std::fabs(double(ref.x[i])), std::fabs(double(ref.dx[i]))));
+    }
+    const double tolerance = (opt.use_float ? 1e-4 : 1e-10) * (1 + max_value);
+    const bool match = out.rows == ref.rows && max_error <= tolerance;
+    std::printf("reference check: %s, max deviation %.3g (tolerance %.3g)\n",
+                match ? "pass" : "FAIL", max_error, tolerance);
+
+    // filtered outputs as doubles, skipping the start-up transient of the first 10%
+    std::vector<double> x(out.x.begin(), out.x.begin() + out.rows * LANES);
+    std::vector<double> dx(out.dx.begin(), out.dx.begin() + out.rows * LANES);
+    const std::size_t skip = out.rows / 10, m = out.rows - skip;
+    const double fs = opt.rate_hz / opt.decimation;
+    static const char* const names[LANES] = {"gyro x", "gyro y", "gyro z", "accel x", "accel y", "accel z"};
+
+    switch (opt.signal) {
+    case Signal::sweep: {
+        // output over input amplitude in short windows along the chirp, angular rate x
+        std::printf("%10s %12s %12s\n", "freq [Hz]", "gain [dB]", "ideal [dB]");
+        const double f0 = 1, f1 = 0.45 * fs, k = std::log(f1 / f0) / opt.seconds;
+        const int windows = 24;
+        for (int w = 1; w < windows; ++w) {
+            const std::size_t a = out.rows * w / windows, b = out.rows * (w + 1) / windows;
+            const double t = out.input_row[(a + b) / 2] / opt.rate_hz;
+            const double f = f0 * std::exp(k * t);
+            const double gain = rms(&x[a * LANES + GYRO], b - a, LANES) * std::sqrt(2.0);
+            std::printf("%10.2f %12.2f %12.2f\n", f, 20 * std::log10(gain),
+                        20 * std::log10(design_gain(opt.config.gyro_family, opt.config.gyro_order, f, opt.config.gyro_cutoff_hz, fs)));
+        }
+        break;
+    }
+    case Signal::noise:
+        std::printf("%-8s %12s %12s %12s\n", "lane", "in rms", "out rms", "deriv rms");
+        for (int l = 0; l < LANES; ++l) {
+            std::printf("%-8s %12.4g %12.4g %12.4g\n", names[l], rms(&signal[skip * LANES + l], n - skip, LANES),
+                        rms(&x[skip * LANES + l], m, LANES), rms(&dx[skip * LANES + l], m, LANES));
+        }
+        break;
+    case Signal::vibration: {
+        // deviation from the true motion, before and after filtering, at the input row of each output
+        std::printf("%-8s %12s %12s %12s %12s\n", "lane", "in error", "out error", "deriv rms", "deriv error");
+        for (int l = 0; l < LANES; ++l) {
+            double in_err = 0, out_err = 0, d_rms = 0, d_err = 0;
+            for (std::size_t i = skip; i < out.rows; ++i) {
+                const std::size_t j = out.input_row[i] * LANES + l;
+                in_err += (signal[j] - truth[j]) * (signal[j] - truth[j]);
+                out_err += (x[i * LANES + l] - truth[j]) * (x[i * LANES + l] - truth[j]);
+                d_rms += truth_derivative[j] * truth_derivative[j];
+                d_err += (dx[i * LANES + l] - truth_derivative[j]) * (dx[i * LANES + l] - truth_derivative[j]);
+            }
+            std::printf("%-8s %12.4g %12.4g %12.4g %12.4g\n", names[l], std::sqrt(in_err / m), std::sqrt(out_err / m),
+                        std::sqrt(d_rms / m), std::sqrt(d_err / m));
+        }
+        std::printf("errors include the filter delay, compare settings rather than absolute values\n");
+        if (c.notch_count > 0) {
+            std::printf("notch centres at the end:");
+            for (int i = 0; i < c.notch_count; ++i) std::printf(" %.1f Hz", out.notch_hz[i]);
+            std::printf(" (motor %.1f Hz)\n", 170 + 20 * std::sin(2 * M_PI * 0.1 * opt.seconds));
+        }
+        break;
+    }
+    }
+
+    if (out.spectrum_reports > 0) {
+        // the last report, as the module publishes it in imu_filter_spectrum
+        const auto& s = out.spectrum;
+        std::printf("spectrum: %u reports of %d frames, last one:\n", out.spectrum_reports, s.frames);
+        std::printf("%10s %12s %12s %12s %12s\n", "freq [Hz]", "gyro in", "gyro out", "accel in", "accel out");
+        for (int k = 0; k < ImuFilterCore<T>::Spectrum::BINS; ++k) {
+            std::printf("%10.2f %12.4g %12.4g %12.4g %12.4g\n", (k + 1) * s.bin_hz, s.in[0][k], s.out[0][k], s.in[1][k], s.out[1][k]);
+        }
+        for (int g = 0; g < 2; ++g) {
+            std::printf("%s noise above %.1f Hz: %.4g -> %.4g, %.1f dB\n", g == 0 ? "gyro" : "accel",
+                        g == 0 ? c.gyro_cutoff_hz : c.accel_cutoff_hz, s.noise_in[g], s.noise_out[g],
+                        10 * std::log10(s.noise_in[g] / s.noise_out[g]));
+        }
+    }
+
+    if (opt.csv != nullptr) {
+        FILE* f = std::fopen(opt.csv, "w");
+        if (f == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", opt.csv);
+            return 2;
+        }
+        std::fprintf(f, "t,gyro_x,gyro_y,gyro_z,accel_x,accel_y,accel_z,angrate_x,angrate_y,angrate_z,"
+                        "accel_f_x,accel_f_y,accel_f_z,angacc_x,angacc_y,angacc_z,jerk_x,jerk_y,jerk_z\n");
+        for (std::size_t i = 0; i < out.rows; ++i) {
+            const std::size_t j = out.input_row[i];
+            std::fprintf(f, "%.6f", j / opt.rate_hz);
+            for (int l = 0; l < LANES; ++l) std::fprintf(f, ",%.9g", signal[j * LANES + l]);
+            for (int l = 0; l < LANES; ++l) std::fprintf(f, ",%.9g", x[i * LANES + l]);
+            for (int l = 0; l < LANES; ++l) std::fprintf(f, ",%.9g", dx[i * LANES + l]);
+            std::fprintf(f, "\n");
+        }
+        std::fclose(f);
+    }
+
+    return match ? 0 : 1;
+}
+
+int usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--signal sweep|noise|vibration] [--rate HZ] [--seconds S] [--batch ROWS]\n"
+                 "          [--decimation 1|2|4|8] [--gyro N:HZ[:TYPE]] [--angacc N:HZ[:TYPE]] [--accel N:HZ[:TYPE]]\n"
+                 "          [--jerk N:HZ[:TYPE]] [--fused angacc|jerk|both] [--notch N:MIN:MAX:BW[:gyro|accel|both]]\n"
+                 "          [--spectrum HZ] [--float] [--repeat N] [--seed N] [--csv FILE]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        ImuFilterConfig& c = opt.config;
+        bool ok = true;
+        if (std::strcmp(arg, "--float") == 0) {
+            opt.use_float = true;
+            continue;
+        }
+        if (value == nullptr) return usage(argv[0]);
+        ++i;
+        if (std::strcmp(arg, "--signal") == 0) {
+            if (std::strcmp(value, "sweep") == 0) opt.signal = Signal::sweep;
+            else if (std::strcmp(value, "noise") == 0) opt.signal = Signal::noise;
+            else if (std::strcmp(value, "vibration") == 0) opt.signal = Signal::vibration;
+            else ok = false;
+        } else if (std::strcmp(arg, "--rate") == 0) {
+            opt.rate_hz = std::atof(value);
+        } else if (std::strcmp(arg, "--seconds") == 0) {
+            opt.seconds = std::atof(value);
+        } else if (std::strcmp(arg, "--batch") == 0) {
+            opt.batch = std::atoi(value);
+        } else if (std::strcmp(arg, "--decimation") == 0) {
+            opt.decimation = std::atoi(value);
+            ok = opt.decimation == 1 || opt.decimation == 2 || opt.decimation == 4 || opt.decimation == 8;
+        } else if (std::strcmp(arg, "--gyro") == 0) {
+            ok = parse_filter(value, c.gyro_family, c.gyro_order, c.gyro_cutoff_hz);
+        } else if (std::strcmp(arg, "--angacc") == 0) {
+            ok = parse_filter(value, c.angacc_family, c.angacc_order, c.angacc_cutoff_hz);
+        } else if (std::strcmp(arg, "--accel") == 0) {
+            ok = parse_filter(value, c.accel_family, c.accel_order, c.accel_cutoff_hz);
+        } else if (std::strcmp(arg, "--jerk") == 0) {
+            ok = parse_filter(value, c.jerk_family, c.jerk_order, c.jerk_cutoff_hz);
+        } else if (std::strcmp(arg, "--fused") == 0) {
+            ok = parse_fused(value, c.angacc_fused, c.jerk_fused);
+        } else if (std::strcmp(arg, "--spectrum") == 0) {
+            c.spectrum_rate_hz = std::atof(value);
+            ok = c.spectrum_rate_hz > 0;
+        } else if (std::strcmp(arg, "--notch") == 0) {
+            ok = parse_notch(value, c);
+        } else if (std::strcmp(arg, "--repeat") == 0) {
+            opt.repeat = std::atoi(value);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            opt.seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--csv") == 0) {
+            opt.csv = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) return usage(argv[0]);
+    }
+
+    // decimation only applies to batches, as in the module's FIFO mode
+    if (opt.batch == 0) opt.decimation = 1;
+    if (!(opt.rate_hz > 0) || !(opt.seconds * opt.rate_hz >= 2) || opt.batch < 0 || opt.repeat < 1) {
+        return usage(argv[0]);
+    }
+
+    return opt.use_float ? simulate<float>(opt) : simulate<double>(opt);
+}
@@ -0,0 +1,70 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Command line helpers shared by the host tools
+
+#pragma once
+#include "FilterDesign.hpp"
+#include "ImuFilterCore.hpp"
+#include <cstdlib>
+#include <string>
+
+// Parses ORDER:CUTOFF[:FAMILY], e.g. 4:30 or 4:30:bessel, with an order between 1 and
+// BUTTERWORTH_MAX_ORDER and a family named as by filter_family_name(), Butterworth if omitted
+inline bool parse_filter(const char* arg, FilterFamily& family, int& order, double& cutoff)
+{
+    char* end = nullptr;
+    const long n = std::strtol(arg, &end, 10);
+    if (*end != ':') return false;
+    const double fc = std::strtod(end + 1, &end);
+    if ((*end != '\0' && *end != ':') || n < 1 || n > BUTTERWORTH_MAX_ORDER || !(fc > 0)) return false;
+
+    FilterFamily f = FilterFamily::butterworth;
+    if (*end == ':') {
+        const std::string name(end + 1);
+        int i = 0;
+        while (i < FILTER_FAMILIES && name != filter_family_name(filter_family(i))) ++i;
+        if (i == FILTER_FAMILIES) return false;
+        f = filter_family(i);
+    }
+    family = f;
+    order = static_cast<int>(n);
+    cutoff = fc;
+    return true;
+}
+
+// Parses angacc, jerk or both, the derivatives to take from their value filter (ImuFilterConfig)
+inline bool parse_fused(const char* arg, bool& angacc, bool& jerk)
+{
+    const std::string value(arg);
+    if (value != "angacc" && value != "jerk" && value != "both") return false;
+    angacc = value != "jerk";
+    jerk = value != "angacc";
+    return true;
+}
+
+// Parses COUNT:MIN:MAX:BANDWIDTH[:gyro|accel|both], dynamic notches on the gyro lanes if omitted
+inline bool parse_notch(const char* arg, ImuFilterConfig& config)
+{
+    char* end = nullptr;
+    const long n = std::strtol(arg, &end, 10);
+    if (*end != ':') return false;
+    const double fmin = std::strtod(end + 1, &end);
+    if (*end != ':') return false;
+    const double fmax = std::strtod(end + 1, &end);
+    if (*end != ':') return false;
+    const double bandwidth = std::strtod(end + 1, &end);
+    if ((*end != '\0' && *end != ':') || n < 0 || n > PeakEstimator::MAX_PEAKS || !(fmin > 0) || !(fmax > fmin)
+        || !(bandwidth > 0)) {
+        return false;
+    }
+
+    const std::string lanes(*end == ':' ? end + 1 : "gyro");
+    if (lanes != "gyro" && lanes != "accel" && lanes != "both") return false;
+    config.notch_count = static_cast<int>(n);
+    config.notch_min_hz = fmin;
+    config.notch_max_hz = fmax;
+    config.notch_bandwidth_hz = bandwidth;
+    config.notch_gyro = lanes != "accel";
+    config.notch_accel = lanes != "gyro";
+    return true;
+}
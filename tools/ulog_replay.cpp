@@ -0,0 +1,354 @@
+// Written by Sinan Cimen, 2025. https://github.com/sinancimen
+
+// Replays the IMU data of a flight log through ImuFilterCore, as the imu_filtering module would
+// have filtered it: every vehicle_angular_velocity message is a step, with the latest
+// vehicle_acceleration message, the sample rate is measured from timestamp_sample and the filters
+// are resynthesized as in the module. The SFILT_* values are those in the log, including changes
+// in flight, unless overridden with --param.
+//
+//     ulog_replay flight.ulg --csv filtered.csv
+//     ulog_replay flight.ulg --ulog filtered.ulg --param SFILT_GYRO_FREQ=150 --param SFILT_DNF_EN=1
+//
+// The log is memory-mapped and read one message at a time (see ULog.hpp), and the outputs are
+// written as they are produced, so memory use does not grow with the size of the log. The output
+// log holds gyro_filtered_data and accel_filtered_data as the module publishes them, with the
+// timestamps of the input messages, and the SFILT_* values used at the start.
+
+#include "ImuFilterCore.hpp"
+#include "ImuLog.hpp"
+#include "ULog.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+namespace {
+
+struct Options {
+    const char* input = nullptr;
+    const char* csv = nullptr;
+    const char* ulog = nullptr;
+    int instance = 0; // multi instance of the input topics
+    bool use_float = false;
+    std::map<std::string, double> overrides; // --param values, win over the log
+};
+
+constexpr int LANES = ImuFilterCore<>::LANES;
+constexpr int GYRO = ImuFilterCore<>::GYRO;
+constexpr int ACCEL = ImuFilterCore<>::ACCEL;
+
+// The module's parameters with their defaults from params.c, int32 ones marked
+struct ParamDefault {
+    const char* name;
+    double value;
+    bool integer;
+};
+
+constexpr ParamDefault PARAMS[] {
+    {"SFILT_GYRO_N", 2, true}, {"SFILT_GYRO_FREQ", 50, false}, {"SFILT_GYRO_TYPE", 0, true},
+    {"SFILT_AACC_N", 2, true}, {"SFILT_AACC_FREQ", 50, false}, {"SFILT_AACC_TYPE", 0, true},
+    {"SFILT_ACCEL_N", 2, true}, {"SFILT_ACCEL_FREQ", 70, false}, {"SFILT_ACCEL_TYPE", 0, true},
+    {"SFILT_JRK_N", 2, true}, {"SFILT_JRK_FREQ", 70, false}, {"SFILT_JRK_TYPE", 0, true},
+    {"SFILT_AACC_FUSE", 0, true}, {"SFILT_JRK_FUSE", 0, true},
+    {"SFILT_DNF_EN", 0, true}, {"SFILT_DNF_CNT", 1, true}, {"SFILT_DNF_MIN", 80, false},
+    {"SFILT_DNF_MAX", 200, false}, {"SFILT_DNF_BW", 20, false}, {"SFILT_SPEC_RATE", 1, false},
+};
+
+bool known_param(const std::string& name)
+{
+    for (const ParamDefault& p : PARAMS) {
+        if (name == p.name) return true;
+    }
+    return false;
+}
+
+// As ImuFiltering::FilterConfig(), cutoffs in rad/s
+ImuFilterConfig filter_config(std::map<std::string, double>& p)
+{
+    ImuFilterConfig c{};
+    c.gyro_family = filter_family(static_cast<int>(p["SFILT_GYRO_TYPE"]));
+    c.gyro_order = static_cast<int>(p["SFILT_GYRO_N"]);
+    c.gyro_cutoff_hz = p["SFILT_GYRO_FREQ"] / 2.0 / M_PI;
+    c.angacc_family = filter_family(static_cast<int>(p["SFILT_AACC_TYPE"]));
+    c.angacc_order = static_cast<int>(p["SFILT_AACC_N"]);
+    c.angacc_cutoff_hz = p["SFILT_AACC_FREQ"] / 2.0 / M_PI;
+    c.accel_family = filter_family(static_cast<int>(p["SFILT_ACCEL_TYPE"]));
+    c.accel_order = static_cast<int>(p["SFILT_ACCEL_N"]);
+    c.accel_cutoff_hz = p["SFILT_ACCEL_FREQ"] / 2.0 / M_PI;
+    c.jerk_family = filter_family(static_cast<int>(p["SFILT_JRK_TYPE"]));
+    c.jerk_order = static_cast<int>(p["SFILT_JRK_N"]);
+    c.jerk_cutoff_hz = p["SFILT_JRK_FREQ"] / 2.0 / M_PI;
+    c.angacc_fused = p["SFILT_AACC_FUSE"] != 0;
+    c.jerk_fused = p["SFILT_JRK_FUSE"] != 0;
+    const int notch = static_cast<int>(p["SFILT_DNF_EN"]);
+    c.notch_gyro = notch & 1;
+    c.notch_accel = notch & 2;
+    c.notch_count = (c.notch_gyro || c.notch_accel) ? static_cast<int>(p["SFILT_DNF_CNT"]) : 0;
+    c.notch_min_hz = p["SFILT_DNF_MIN"];
+    c.notch_max_hz = p["SFILT_DNF_MAX"];
+    c.notch_bandwidth_hz = p["SFILT_DNF_BW"];
+    c.spectrum_rate_hz = p["SFILT_SPEC_RATE"];
+    return c;
+}
+
+template <typename T>
+int replay(const Options& opt)
+{
+    ulog::ULogReader reader;
+    std::string error;
+    if (!reader.open(opt.input, error)) {
+        std::fprintf(stderr, "%s: %s\n", opt.input, error.c_str());
+        return 2;
+    }
+
+    FILE* csv = nullptr;
+    if (opt.csv != nullptr) {
+        csv = std::fopen(opt.csv, "w");
+        if (csv == nullptr) {
+            std::fprintf(stderr, "cannot write %s\n", opt.csv);
+            return 2;
+        }
+        std::fprintf(csv, "timestamp_sample,device_id,gyro_x,gyro_y,gyro_z,accel_x,accel_y,accel_z,angrate_x,angrate_y,angrate_z,"
+                          "angacc_x,angacc_y,angacc_z,accel_f_x,accel_f_y,accel_f_z,jerk_x,jerk_y,jerk_z\n");
+    }
+
+    ulog::ULogWriter out;
+    uint16_t gyro_out_id = 0, accel_out_id = 0;
+    if (opt.ulog != nullptr) {
+        if (!out.open(opt.ulog, reader.startTime())) {
+            std::fprintf(stderr, "cannot write %s\n", opt.ulog);
+            return 2;
+        }
+        out.format("gyro_filtered_data:uint64_t timestamp;uint64_t timestamp_sample;uint32_t device_id;float[3] angrate_radps;float[3] angacc_radps2;");
+        out.format("accel_filtered_data:uint64_t timestamp;uint64_t timestamp_sample;uint32_t device_id;float[3] accel_mps2;float[3] jerk_mps3;");
+    }
+
+    std::map<std::string, double> params;
+    for (const ParamDefault& p : PARAMS) params[p.name] = p.value;
+    for (const auto& o : opt.overrides) params[o.first] = o.second;
+
+    ImuFilterCore<T> core;
+    RateTracker rate;
+    ImuFilterConfig config = filter_config(params);
+    ImuLayout gyro_layout, accel_layout;
+    float accel_hold[3] {};
+    T x[LANES], dx[LANES];
+    std::size_t messages = 0, gyro_samples = 0, accel_samples = 0, retunes = 0, rejected = 0, duplicates = 0;
+    uint64_t first_sample = 0, last_sample = 0;
+
+    const auto configure = [&](double rate_hz) {
+        if (!core.configure(config, rate_hz)) {
+            rejected++;
+            std::fprintf(stderr, "invalid filter design at %.1f Hz, keeping previous coefficients\n", rate_hz);
+        }
+    };
+
+    int status = 0;
+    const auto t0 = std::chrono::steady_clock::now();
+    ulog::Message m;
+    while (status == 0 && reader.next(m)) {
+        messages++;
+
+        if (m.type == 'P') {
+            std::string name;
+            double value;
+            if (!ulog::parameter(m, name, value) || !known_param(name) || opt.overrides.count(name) > 0) continue;
+            params[name] = value;
+            const ImuFilterConfig updated = filter_config(params);
+            if (updated != config) {
+                config = updated;
+                // the definitions section sets the start values, later ones are changes in flight
+                if (core.sampleRate() > 0) {
+                    configure(core.sampleRate());
+                    retunes++;
+                }
+            }
+            continue;
+        }
+
+        if (m.type == 'A') {
+            if (gyro_layout.id < 0) {
+                const int id = reader.subscription("vehicle_angular_velocity", opt.instance);
+                if (id >= 0 && !gyro_layout.resolve(reader, "vehicle_angular_velocity", id)) {
+                    std::fprintf(stderr, "unexpected vehicle_angular_velocity format\n");
+                    status = 2;
+                }
+            }
+            if (accel_layout.id < 0) {
+                const int id = reader.subscription("vehicle_acceleration", opt.instance);
+                if (id >= 0 && !accel_layout.resolve(reader, "vehicle_acceleration", id)) {
+                    std::fprintf(stderr, "unexpected vehicle_acceleration format\n");
+                    status = 2;
+                }
+            }
+            continue;
+        }
+
+        if (m.type != 'D' || m.size < 2) continue;
+        uint16_t id;
+        std::memcpy(&id, m.data, sizeof(id));
+        const uint8_t* payload = m.data + 2;
+
+        if (id == accel_layout.id && m.size >= 2 + accel_layout.size) {
+            std::memcpy(accel_hold, payload + accel_layout.xyz, sizeof(accel_hold));
+            // the filters started on a zero acceleration, warm-start them again at the first one
+            if (accel_samples++ == 0) core.restart();
+            continue;
+        }
+        if (id != gyro_layout.id || m.size < 2 + gyro_layout.size) continue;
+
+        uint64_t timestamp, timestamp_sample;
+        float gyro[3];
+        std::memcpy(&timestamp, payload + gyro_layout.timestamp, sizeof(timestamp));
+        std::memcpy(&timestamp_sample, payload + gyro_layout.timestamp_sample, sizeof(timestamp_sample));
+        std::memcpy(gyro, payload + gyro_layout.xyz, sizeof(gyro));
+
+        const uint32_t device_id = 0; // the module's device_id for the vehicle topics it filters here
+        if (core.sampleRate() == 0) configure(1 / rate.step_s); // as in the module's init()
+        if (rate.last_us != 0 && timestamp_sample <= rate.last_us) { // republished or out of order, as in the module
+            duplicates++;
+            continue;
+        }
+
+        double retune_hz;
+        const double dt_s = rate.update(timestamp_sample, core.sampleRate(), retune_hz);
+        if (retune_hz > 0) {
+            configure(retune_hz);
+            retunes++;
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            x[GYRO + i] = gyro[i];
+            x[ACCEL + i] = accel_hold[i];
+        }
+        core.step(x, static_cast<T>(dt_s), x, dx);
+        gyro_samples++;
+        first_sample = first_sample == 0 ? timestamp_sample : first_sample;
+        last_sample = timestamp_sample;
+
+        if (csv != nullptr) {
+            std::fprintf(csv, "%llu,%u", static_cast<unsigned long long>(timestamp_sample), (unsigned)device_id);
+            for (int i = 0; i < 3; ++i) std::fprintf(csv, ",%.9g", gyro[i]);
+            for (int i = 0; i < 3; ++i) std::fprintf(csv, ",%.9g", accel_hold[i]);
+            for (int i = 0; i < 3; ++i) std::fprintf(csv, ",%.9g", double(x[GYRO + i]));
+            for (int i = 0; i < 3; ++i) std::fprintf(csv, ",%.9g", double(dx[GYRO + i]));
+            for (int i = 0; i < 3; ++i) std::fprintf(csv, ",%.9g", double(x[ACCEL + i]));
+            for (int i = 0; i < 3; ++i) std::fprintf(csv, ",%.9g", double(dx[ACCEL + i]));
+            std::fprintf(csv, "\n");
+        }
+
+        if (opt.ulog != nullptr) {
+            if (gyro_samples == 1) { // values at the first sample, then the subscriptions
+                for (const ParamDefault& p : PARAMS) {
+                    if (p.integer) out.parameter(p.name, static_cast<int32_t>(params[p.name]));
+                    else out.parameter(p.name, static_cast<float>(params[p.name]));
+                }
+                gyro_out_id = out.subscribe("gyro_filtered_data");
+                accel_out_id = out.subscribe("accel_filtered_data");
+            }
+            // uint64 timestamp, uint64 timestamp_sample, uint32 device_id, float[3], float[3]
+            uint8_t buffer[20 + 24];
+            float values[6];
+            std::memcpy(buffer, &timestamp, 8);
+            std::memcpy(buffer + 8, &timestamp_sample, 8);
+            std::memcpy(buffer + 16, &device_id, 4);
+            for (int i = 0; i < 3; ++i) {
+                values[i] = static_cast<float>(x[GYRO + i]);
+                values[3 + i] = static_cast<float>(dx[GYRO + i]);
+            }
+            std::memcpy(buffer + 20, values, sizeof(values));
+            out.data(gyro_out_id, buffer, sizeof(buffer));
+            for (int i = 0; i < 3; ++i) {
+                values[i] = static_cast<float>(x[ACCEL + i]);
+                values[3 + i] = static_cast<float>(dx[ACCEL + i]);
+            }
+            std::memcpy(buffer + 20, values, sizeof(values));
+            out.data(accel_out_id, buffer, sizeof(buffer));
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    bool ok = true;
+    if (csv != nullptr) ok = std::fclose(csv) == 0 && ok;
+    if (opt.ulog != nullptr) ok = out.close() && ok;
+    if (!ok) std::fprintf(stderr, "error writing the output\n");
+    if (status != 0) return status;
+
+    if (gyro_layout.id < 0) {
+        std::fprintf(stderr, "%s: no vehicle_angular_velocity instance %d in the log\n", opt.input, opt.instance);
+        return 1;
+    }
+
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    const double seconds = (last_sample - first_sample) * 1e-6;
+    std::printf("%zu messages, %.1f MB in %.2f s, %.0f MB/s, max resident %.1f MB\n", messages, reader.size() / 1e6,
+                elapsed, reader.size() / 1e6 / elapsed, usage.ru_maxrss / 1024.0);
+    std::printf("%zu angular velocity and %zu acceleration samples over %.1f s, %.1f Hz\n", gyro_samples, accel_samples,
+                seconds, seconds > 0 ? (gyro_samples - 1) / seconds : 0.0);
+    std::printf("filter rate %.1f Hz, %zu retunes, %zu invalid designs, %u dropped and %zu duplicate samples\n",
+                core.sampleRate(), retunes, rejected, rate.dropped, duplicates);
+    if (reader.position() < reader.size()) {
+        std::printf("stopped at a truncated message %zu bytes before the end\n", reader.size() - reader.position());
+    }
+    if (accel_layout.id < 0) std::printf("no vehicle_acceleration in the log, acceleration outputs are zero\n");
+    return ok ? 0 : 2;
+}
+
+int usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s LOG.ulg [--csv FILE] [--ulog FILE] [--param SFILT_NAME=VALUE]... [--instance N]\n"
+                 "          [--float]\n", argv0);
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (arg[0] != '-') {
+            if (opt.input != nullptr) return usage(argv[0]);
+            opt.input = arg;
+            continue;
+        }
+        if (std::strcmp(arg, "--float") == 0) {
+            opt.use_float = true;
+            continue;
+        }
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (value == nullptr) return usage(argv[0]);
+        ++i;
+        bool ok = true;
+        if (std::strcmp(arg, "--csv") == 0) {
+            opt.csv = value;
+        } else if (std::strcmp(arg, "--ulog") == 0) {
+            opt.ulog = value;
+        } else if (std::strcmp(arg, "--instance") == 0) {
+            opt.instance = std::atoi(value);
+        } else if (std::strcmp(arg, "--param") == 0) {
+            const char* eq = std::strchr(value, '=');
+            const std::string name = eq != nullptr ? std::string(value, eq) : "";
+            char* end = nullptr;
+            const double v = eq != nullptr ? std::strtod(eq + 1, &end) : 0;
+            ok = known_param(name) && end != eq + 1 && *end == '\0';
+            if (ok) opt.overrides[name] = v;
+        } else {
+            ok = false;
+        }
+        if (!ok) return usage(argv[0]);
+    }
+    if (opt.input == nullptr || opt.instance < 0) return usage(argv[0]);
+
+    return opt.use_float ? replay<float>(opt) : replay<double>(opt);
+}